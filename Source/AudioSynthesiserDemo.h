@@ -27,37 +27,261 @@
 
 #pragma once
 #include <cmath>
-#include "MorphingOscillator.h"
+#include "CallbackProfiler.h"
+#include "CompressedWavetableBank.h"
+#include "EngineSettings.h"
+#include "MasterEffects.h"
+#include "MorphSynth.h"
+#include "RenderAhead.h"
+#include "ThreadTuning.h"
+#include "WavetableCache.h"
 
 struct SynthAudioSource final : public AudioSource
 {
     SynthAudioSource (MidiKeyboardState& keyState)  : keyboardState (keyState)
     {
-        synth.addVoice (new MorphingWaveformVoice());
+        for (int i = 0; i < settings.numVoices; ++i)
+            synth.addVoice (new MorphingWaveformVoice (wavetables));
+
         synth.clearSounds();
         synth.addSound (new MorphingWaveformSound());
+        synth.setSpectralMorph (&spectralMorph);
+
+        // Nothing renders until the device calls prepareToPlay
+        wavetables.setReaderActive (false);
+        spectralMorph.setReaderActive (false);
     }
 
-    void prepareToPlay (int /*samplesPerBlockExpected*/, double sampleRate) override
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override
     {
+        renderAhead.stop();
         midiCollector.reset (sampleRate);
+        midiCollector.ensureStorageAllocated (settings.midiBufferBytes);
+        incomingMidi.ensureSize (settings.midiBufferBytes);
         synth.setCurrentPlaybackSampleRate (sampleRate);
+
+        // Measure first, then reserve and hand out the real memory
+        RealtimeArena sizing;
+        prepareVoices (sizing, samplesPerBlockExpected, sampleRate);
+        renderAhead.allocate (sizing, samplesPerBlockExpected);
+        effects.allocate (sizing, samplesPerBlockExpected, sampleRate);
+
+        // Without the memory the voices would be handed null buffers, so stay silent instead
+        memoryReserved = arena.reserve (sizing.getBytesUsed(), settings.lockRealtimeMemory);
+
+        if (! memoryReserved)
+        {
+            DBG ("Realtime memory: couldn't reserve " << (int) sizing.getBytesUsed() << " bytes, output muted");
+            return;
+        }
+
+        prepareVoices (arena, samplesPerBlockExpected, sampleRate);
+        renderAhead.allocate (arena, samplesPerBlockExpected);
+        effects.allocate (arena, samplesPerBlockExpected, sampleRate);
+        effects.prepare (sampleRate);
+        preparedBlockSize = samplesPerBlockExpected;
+        wavetables.setReaderActive (true);
+        spectralMorph.setReaderActive (true);
+        renderAhead.start();
+
+        // The audio thread tunes itself at its next callback
+        ThreadTuning::setRealtimeCores (settings.realtimeCoreMask);
+        audioThreadNeedsTuning = true;
+        profiler.prepare (sampleRate);
+        silentSamplesInARow = 0;
+
+        DBG ("Realtime memory: " << (int) getMemoryFootprint() << " bytes"
+             << (arena.isLocked() ? " (locked)" : ""));
     }
 
-    void releaseResources() override {}
+    /// Also called when an idle device is suspended. Nothing renders from here
+    /// on, so the publishers reclaim retired tables without waiting for blocks.
+    void releaseResources() override
+    {
+        renderAhead.stop();
+        wavetables.setReaderActive (false);
+        spectralMorph.setReaderActive (false);
+    }
 
     void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override
     {
-        bufferToFill.clearActiveBufferRegion();
-        MidiBuffer incomingMidi;
-        midiCollector.removeNextBlockOfMessages (incomingMidi, bufferToFill.numSamples);
-        keyboardState.processNextMidiBuffer (incomingMidi, 0, bufferToFill.numSamples, true);
-        synth.renderNextBlock (*bufferToFill.buffer, incomingMidi, 0, bufferToFill.numSamples);
+        if (audioThreadNeedsTuning)
+        {
+            audioThreadNeedsTuning = false;
+            ThreadTuning::tuneRealtimeThread (settings, audioThreadReport);
+        }
+
+        if (! memoryReserved)
+        {
+            bufferToFill.clearActiveBufferRegion();
+            return;
+        }
+
+        const CallbackProfiler::ScopedMeasurement measurement (profiler, bufferToFill.numSamples);
+
+        renderAhead.process (*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    }
+
+    /// Renders the synth into a cleared buffer, on the audio thread or the
+    /// render-ahead worker, whichever currently owns rendering.
+    void renderSynth (AudioBuffer<float>& buffer, int numSamples)
+    {
+        buffer.clear();
+        incomingMidi.clear();
+        midiCollector.removeNextBlockOfMessages (incomingMidi, numSamples);
+        keyboardState.processNextMidiBuffer (incomingMidi, 0, numSamples, true);
+
+        // Silence fast path: nothing sounding (voices free themselves once their
+        // tails are done) and nothing arriving, so the zeroed buffer is the answer
+        auto silent = incomingMidi.isEmpty() && ! hasActiveVoices();
+
+        if (silent)
+        {
+            numSilentBlocks.fetch_add (1, std::memory_order_relaxed);
+        }
+        else
+        {
+            synth.renderNextBlock (buffer, incomingMidi, 0, numSamples);
+            numRenderedBlocks.fetch_add (1, std::memory_order_relaxed);
+        }
+
+        // Delay and reverb tails outlast the voices, so the output is only idle once they have died away
+        if (effects.isActive())
+        {
+            effects.process (buffer, numSamples);
+            silent = silent && buffer.getMagnitude (0, numSamples) < silenceThreshold;
+        }
+
+        if (silent)
+            silentSamplesInARow.fetch_add (numSamples, std::memory_order_relaxed);
+        else
+            silentSamplesInARow.store (0, std::memory_order_relaxed);
+
+        wavetables.markBlockBoundary();
+        spectralMorph.markBlockBoundary();
+    }
+
+    bool hasActiveVoices() const noexcept
+    {
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+            if (synth.getVoice (i)->isVoiceActive())
+                return true;
+
+        return false;
+    }
+
+    /// Message thread: how long the engine has been producing nothing but silence.
+    double getIdleSeconds() const
+    {
+        auto sampleRate = synth.getSampleRate();
+        return sampleRate > 0.0 ? (double) silentSamplesInARow.load (std::memory_order_relaxed) / sampleRate : 0.0;
+    }
+
+    /// Message thread: renders this many blocks ahead of the device, or 0 for
+    /// interactive playback. Switches without a click.
+    void setRenderAhead (int numBlocks)
+    {
+        renderAhead.setDepth (numBlocks);
+    }
+
+    /// Switches every voice to a new sound at the next block. Message thread.
+    void setPatch (const Patch& patch)
+    {
+        synth.setPatch (patch);
+    }
+
+    /// Retunes the synth, including notes already playing. Message thread.
+    void setTuning (const Tuning& tuning)
+    {
+        synth.setTuning (tuning);
+    }
+
+    /// Swaps the voices over to a new wavetable set without stopping playback.
+    /// Message thread only.
+    void loadWavetables (WavetableSet::Ptr newTables)
+    {
+        wavetables.publish (std::move (newTables));
+        spectralMorph.setSource (wavetables.getCurrent());
     }
 
+    /// Message thread: callback timings and how the audio thread was tuned.
+    String getStatusReport() const
+    {
+        auto silent = numSilentBlocks.load (std::memory_order_relaxed);
+        auto total = jmax ((int64) 1, silent + numRenderedBlocks.load (std::memory_order_relaxed));
+
+        auto report = profiler.getStatistics().toString() + "\n" + audioThreadReport.describe (settings)
+                        + "; " + String (100 * silent / total) + "% of blocks silent";
+
+        auto separator = "\n";
+
+        for (int stage = 0; stage < MasterEffects::numStages; ++stage)
+        {
+            if (! effects.isEnabled (stage))
+                continue;
+
+            auto stats = effects.getProfiler (stage).getStatistics();
+            report << separator << MasterEffects::getStageName (stage) << " " << String (stats.p99Microseconds, 0)
+                   << " / " << String (stats.maxMicroseconds, 0) << " us";
+            separator = ", ";
+        }
+
+        auto& mapping = synth.midiMapping;
+
+        if (auto learning = mapping.getLearningParameter(); learning >= 0)
+            report << "; MIDI learn: move a controller for " << MidiMapping::getParameterName (learning);
+
+        for (auto& binding : mapping.getBindings())
+            report << "; " << MidiMapping::getParameterName (binding.parameter) << " on " << binding.controller.describe();
+
+        report << "; " << synth.getKernelUsage().describe();
+
+        if (renderAhead.getDepth() > 0 || renderAhead.isWorkerRendering())
+            report << "; render-ahead " << renderAhead.getDepth() << " blocks ("
+                   << renderAhead.getWorkerReport().describe (settings) << "), "
+                   << renderAhead.getNumUnderruns() << " underruns";
+
+        return report;
+    }
+
+    /// Total bytes the engine keeps resident for the audio thread: the arena,
+    /// the MIDI buffers, the voices, the synth itself (tuning tables included)
+    /// and what the chorus and reverb allocate outside the arena.
+    size_t getMemoryFootprint() const
+    {
+        return arena.getCapacity()
+             + 2 * settings.midiBufferBytes
+             + (size_t) synth.getNumVoices() * sizeof (MorphingWaveformVoice)
+             + sizeof (MorphSynth)
+             + MasterEffects::getUnpooledBytes (synth.getSampleRate(), preparedBlockSize);
+    }
+
+    void prepareVoices (RealtimeArena& target, int maximumBlockSize, double sampleRate)
+    {
+        target.rewind();
+        synth.prepare (target, maximumBlockSize, sampleRate);
+    }
+
+    /// Peak level (-100 dB) below which effect tails count as silence.
+    static constexpr float silenceThreshold = 1.0e-5f;
+
+    SharedResourcePointer<WavetableStore> store;
+    WavetablePublisher wavetables { *store, store->getClassicShapes() };
+    SpectralMorph spectralMorph { *store, wavetables.getCurrent() };
+    EngineSettings settings;
+    CallbackProfiler profiler;
+    ThreadTuning::Report audioThreadReport;
+    std::atomic<bool> audioThreadNeedsTuning { false };
+    std::atomic<int64> numSilentBlocks { 0 }, numRenderedBlocks { 0 }, silentSamplesInARow { 0 };
+    RealtimeArena arena;
+    std::atomic<bool> memoryReserved { false };
+    int preparedBlockSize = 0;
+    MasterEffects effects;
+    RenderAhead renderAhead { settings, [this] (AudioBuffer<float>& buffer, int numSamples) { renderSynth (buffer, numSamples); } };
+    MidiBuffer incomingMidi;
     MidiMessageCollector midiCollector;
     MidiKeyboardState& keyboardState;
-    Synthesiser synth;
+    MorphSynth synth;
 };
 
 class Callback final : public AudioIODeviceCallback
@@ -94,7 +318,63 @@ private:
     AudioSourcePlayer& player;
 };
 
-class AudioSynthesiserDemo final : public Component
+/// An XY pad for the vector morph: x is the morph position and y its second
+/// axis, both 0..1, with y growing upwards.
+class VectorPad final : public Component
+{
+public:
+    std::function<void()> onChange, onDragStart;
+
+    Point<double> getPosition() const noexcept          { return position; }
+
+    void setPosition (Point<double> newPosition)
+    {
+        position = newPosition;
+        repaint();
+    }
+
+    void paint (Graphics& g) override
+    {
+        auto area = getPadArea();
+        g.setColour (Colours::darkgrey);
+        g.fillRect (area);
+        g.setColour (Colours::white);
+        g.drawRect (area, 1.0f);
+
+        auto x = area.getX() + (float) position.x * area.getWidth();
+        auto y = area.getBottom() - (float) position.y * area.getHeight();
+        g.fillEllipse (x - 5.0f, y - 5.0f, 10.0f, 10.0f);
+    }
+
+    void mouseDown (const MouseEvent& e) override
+    {
+        if (onDragStart)
+            onDragStart();
+
+        mouseDrag (e);
+    }
+
+    void mouseDrag (const MouseEvent& e) override
+    {
+        auto area = getPadArea();
+        setPosition ({ jlimit (0.0, 1.0, (double) ((e.position.x - area.getX()) / area.getWidth())),
+                       jlimit (0.0, 1.0, (double) ((area.getBottom() - e.position.y) / area.getHeight())) });
+
+        if (onChange)
+            onChange();
+    }
+
+private:
+    Rectangle<float> getPadArea() const     { return getLocalBounds().toFloat().reduced (4.0f); }
+
+    Point<double> position;
+};
+
+class AudioSynthesiserDemo final : public Component,
+                                   private Timer,
+                                   private AsyncUpdater,
+                                   private MidiInputCallback,
+                                   private MidiKeyboardState::Listener
 {
 public:
     AudioSynthesiserDemo()
@@ -104,32 +384,168 @@ public:
         audioSourcePlayer.setSource (&synthAudioSource);
         
         addAndMakeVisible(waveformBlend);
-        waveformBlend.setRange (0.0, 2.0, 0.01);
+        waveformBlend.setRange (0.0, 3.0, 0.01);
         waveformBlend.setValue(0.0, dontSendNotification);
-        waveformBlend.onValueChange = [this]() {
-            auto& synth = synthAudioSource.synth;
-            MorphingWaveformVoice* voice = static_cast<MorphingWaveformVoice*>(synth.getVoice(0));
-            voice->updateMorphFunctions(waveformBlend.getValue());
+        waveformBlend.onValueChange = [this]
+        {
+            patch.morph = waveformBlend.getValue() / waveformBlend.getMaximum();
+            synthAudioSource.setPatch (patch);
         };
+        waveformBlend.onDragStart = [this] { armMidiLearn (MidiMapping::morphParameter); };
+        addAndMakeVisible (morphLfoDepth);
+        morphLfoDepth.setRange (0.0, 1.0, 0.01);
+        morphLfoDepth.onDragStart = [this] { armMidiLearn (MidiMapping::getRouteParameter (ModSource::lfo, ModDestination::morph)); };
+        morphLfoDepth.onValueChange = [this]
+        {
+            patch.modulation.setRoute (ModSource::lfo, ModDestination::morph, (float) morphLfoDepth.getValue());
+            synthAudioSource.setPatch (patch);
+        };
+        addAndMakeVisible (morphLfoLabel);
+        morphLfoLabel.setText ("LFO", dontSendNotification);
+        morphLfoLabel.attachToComponent (&morphLfoDepth, true);
+        addAndMakeVisible (noiseMix);
+        noiseMix.setRange (0.0, 1.0, 0.01);
+        noiseMix.onValueChange = [this]
+        {
+            patch.modulation.noise.mix = (float) noiseMix.getValue();
+            synthAudioSource.setPatch (patch);
+        };
+        addAndMakeVisible (noiseMixLabel);
+        noiseMixLabel.setText ("Noise", dontSendNotification);
+        noiseMixLabel.attachToComponent (&noiseMix, true);
+
+        // Item ids are the NoiseParameters::Colour plus one
+        addAndMakeVisible (noiseColourBox);
+        noiseColourBox.addItem ("White", (int) NoiseParameters::Colour::white + 1);
+        noiseColourBox.addItem ("Pink", (int) NoiseParameters::Colour::pink + 1);
+        noiseColourBox.addItem ("Brown", (int) NoiseParameters::Colour::brown + 1);
+        noiseColourBox.setSelectedId ((int) patch.modulation.noise.colour + 1, dontSendNotification);
+        noiseColourBox.onChange = [this]
+        {
+            patch.modulation.noise.colour = (NoiseParameters::Colour) (noiseColourBox.getSelectedId() - 1);
+            synthAudioSource.setPatch (patch);
+        };
+
+        addChildComponent (vectorPad);
+        vectorPad.onChange = [this]
+        {
+            patch.morph = vectorPad.getPosition().x;
+            patch.morphY = vectorPad.getPosition().y;
+            waveformBlend.setValue (patch.morph * waveformBlend.getMaximum(), dontSendNotification);
+            synthAudioSource.setPatch (patch);
+        };
+        vectorPad.onDragStart = [this] { armMidiLearn (MidiMapping::morphYParameter); };
+
+        addAndMakeVisible (vectorToggle);
+        vectorToggle.onClick = [this]
+        {
+            patch.modulation.vector.enabled = vectorToggle.getToggleState();
+            showVectorPad();
+            synthAudioSource.setPatch (patch);
+        };
+
         addAndMakeVisible(waveformBlendLabel);
         waveformBlendLabel.setText("Waveform", juce::dontSendNotification);
         waveformBlendLabel.attachToComponent(&waveformBlend, true);
 
+        addAndMakeVisible (loadWavetableButton);
+        loadWavetableButton.onClick = [this] { chooseWavetable(); };
+        addAndMakeVisible (previousWavetableButton);
+        previousWavetableButton.onClick = [this] { selectWavetable (wavetableIndex - 1); };
+        addAndMakeVisible (nextWavetableButton);
+        nextWavetableButton.onClick = [this] { selectWavetable (wavetableIndex + 1); };
+
+        addAndMakeVisible (spectralMorphToggle);
+        spectralMorphToggle.onClick = [this]
+        {
+            patch.modulation.morphMode = spectralMorphToggle.getToggleState() ? MorphMode::spectral : MorphMode::crossfade;
+            synthAudioSource.setPatch (patch);
+        };
+
+        // Item ids are the OscillatorMode plus one
+        addAndMakeVisible (oscillatorModeBox);
+        oscillatorModeBox.addItem ("Tables", (int) OscillatorMode::wavetable + 1);
+        oscillatorModeBox.addItem ("Additive", (int) OscillatorMode::additive + 1);
+        oscillatorModeBox.addItem ("Auto kernel", (int) OscillatorMode::automatic + 1);
+        oscillatorModeBox.setSelectedId ((int) patch.modulation.oscillatorMode + 1, dontSendNotification);
+        oscillatorModeBox.onChange = [this]
+        {
+            patch.modulation.oscillatorMode = (OscillatorMode) (oscillatorModeBox.getSelectedId() - 1);
+            synthAudioSource.setPatch (patch);
+        };
+
+        addAndMakeVisible (renderAheadToggle);
+        renderAheadToggle.onClick = [this]
+        {
+            synthAudioSource.setRenderAhead (renderAheadToggle.getToggleState() ? 4 : 0);
+        };
+
+        for (int stage = 0; stage < MasterEffects::numStages; ++stage)
+        {
+            auto* toggle = effectToggles.add (new ToggleButton (MasterEffects::getStageName (stage)));
+            addAndMakeVisible (toggle);
+            toggle->onClick = [this, stage, toggle]
+            {
+                synthAudioSource.effects.setEnabled (stage, toggle->getToggleState());
+            };
+        }
+
+        addAndMakeVisible (midiLearnToggle);
+        midiLearnToggle.onClick = [this]
+        {
+            if (midiLearnToggle.getToggleState())
+                startTimer (100);
+            else
+                synthAudioSource.synth.midiMapping.stopLearning();
+        };
+
+        addAndMakeVisible (presetBox);
+        presets.loadFrom (getPresetFile());
+        updatePresetBox();
+        presetBox.setSelectedId (1, dontSendNotification);
+        presetBox.onChange = [this]
+        {
+            auto id = presetBox.getSelectedId();
+
+            if (id == saveItemId())
+                saveNewPreset();
+            else
+                selectPreset (id - 1);
+        };
+
+        addAndMakeVisible (loadTuningButton);
+        loadTuningButton.onClick = [this] { chooseTuning(); };
+
+        addAndMakeVisible (libraryBox);
+        libraryBox.setTextWhenNothingSelected ("Library");
+
+        for (int i = 0; i < numLibraryTables; ++i)
+            libraryBox.addItem ("Sweep " + String (i + 1), i + 1);
+
+        libraryBox.onChange = [this] { selectLibraryTable (libraryBox.getSelectedId() - 1); };
+
+        addAndMakeVisible (statusLabel);
+        statusLabel.setFont (statusLabel.getFont().withHeight (11.0f));
+        statusLabel.setJustificationType (Justification::centredLeft);
+
        #ifndef JUCE_DEMO_RUNNER
         audioDeviceManager.initialise (0, 2, nullptr, true, {}, nullptr);
        #endif
 
         audioDeviceManager.addAudioCallback (&callback);
-        audioDeviceManager.addMidiInputDeviceCallback ({}, &(synthAudioSource.midiCollector));
+        audioDeviceManager.addMidiInputDeviceCallback ({}, this);
+        keyboardState.addListener (this);
 
         setOpaque (true);
-        setSize (600, 200);
+        setSize (600, 250);
+        startTimer (1000);
     }
 
     ~AudioSynthesiserDemo() override
     {
         audioSourcePlayer.setSource (nullptr);
-        audioDeviceManager.removeMidiInputDeviceCallback ({}, &(synthAudioSource.midiCollector));
+        keyboardState.removeListener (this);
+        audioDeviceManager.removeMidiInputDeviceCallback ({}, this);
         audioDeviceManager.removeAudioCallback (&callback);
     }
 
@@ -142,11 +558,255 @@ public:
     {
         auto width = getWidth();
         auto height = getHeight();
-        keyboardComponent   .setBounds (0, height * 0.2, width, height * 0.8);
-        waveformBlend       .setBounds (width * 0.25, 0, width * 0.5, height * 0.2);
+        keyboardComponent   .setBounds (0, height * 0.2, width, height * 0.54);
+        statusLabel         .setBounds (0, height * 0.84, width * 0.36, height * 0.16);
+        noiseColourBox      .setBounds (width * 0.36, height * 0.88, width * 0.08, height * 0.08);
+        vectorToggle        .setBounds (width * 0.44, height * 0.84, width * 0.1, height * 0.16);
+        oscillatorModeBox   .setBounds (width * 0.54, height * 0.88, width * 0.12, height * 0.08);
+        spectralMorphToggle .setBounds (width * 0.66, height * 0.84, width * 0.14, height * 0.16);
+        renderAheadToggle   .setBounds (width * 0.8, height * 0.84, width * 0.2, height * 0.16);
+        waveformBlend       .setBounds (width * 0.2, 0, width * 0.25, height * 0.2);
+        vectorPad           .setBounds (width * 0.2, 0, width * 0.25, height * 0.2);
+        morphLfoDepth       .setBounds (width * 0.5, 0, width * 0.12, height * 0.2);
+        noiseMix            .setBounds (width * 0.67, 0, width * 0.08, height * 0.2);
+        previousWavetableButton.setBounds (width * 0.76, height * 0.04, width * 0.04, height * 0.12);
+        loadWavetableButton .setBounds (width * 0.81, height * 0.04, width * 0.13, height * 0.12);
+        nextWavetableButton .setBounds (width * 0.95, height * 0.04, width * 0.04, height * 0.12);
+
+        for (int stage = 0; stage < effectToggles.size(); ++stage)
+            effectToggles[stage]->setBounds (width * 0.12 * stage, height * 0.74, width * 0.12, height * 0.1);
+
+        midiLearnToggle     .setBounds (width * 0.48, height * 0.74, width * 0.15, height * 0.1);
+        presetBox           .setBounds (width * 0.64, height * 0.75, width * 0.16, height * 0.08);
+        loadTuningButton    .setBounds (width * 0.81, height * 0.75, width * 0.09, height * 0.08);
+        libraryBox          .setBounds (width * 0.91, height * 0.75, width * 0.08, height * 0.08);
+    }
+
+    /// Lets the user pick a wavetable file; the other audio files in its
+    /// folder become the list the arrow buttons step through.
+    void chooseWavetable()
+    {
+        wavetableChooser = std::make_unique<FileChooser> ("Choose a wavetable", File(), "*.wav;*.aif;*.aiff;*.flac");
+        wavetableChooser->launchAsync (FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles,
+                                       [this] (const FileChooser& chooser)
+        {
+            auto file = chooser.getResult();
+
+            if (! file.existsAsFile())
+                return;
+
+            wavetableFiles = file.getParentDirectory().findChildFiles (File::findFiles, false, "*.wav;*.aif;*.aiff;*.flac");
+            wavetableFiles.sort();
+            selectWavetable (wavetableFiles.indexOf (file));
+        });
+    }
+
+    /// Lets the user pick a Scala scale. A keyboard mapping (.kbm) next to it
+    /// with the same name is used as well.
+    void chooseTuning()
+    {
+        tuningChooser = std::make_unique<FileChooser> ("Choose a Scala tuning", File(), "*.scl");
+        tuningChooser->launchAsync (FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles,
+                                    [this] (const FileChooser& chooser)
+        {
+            auto file = chooser.getResult();
+            Tuning tuning;
+
+            if (! tuning.loadScala (file, file.withFileExtension ("kbm")))
+                return;
+
+            synthAudioSource.setTuning (tuning);
+            loadTuningButton.setButtonText (tuning.getDescription().isNotEmpty() ? tuning.getDescription() : file.getFileNameWithoutExtension());
+        });
+    }
+
+    static File getPresetFile()
+    {
+        return File::getSpecialLocation (File::userApplicationDataDirectory)
+                 .getChildFile ("MorphingOscillatorDemo").getChildFile ("Presets.xml");
+    }
+
+    /// Lists every preset, then an item that saves the current sound as a new one.
+    void updatePresetBox()
+    {
+        presetBox.clear (dontSendNotification);
+
+        for (int i = 0; i < presets.getNumPresets(); ++i)
+            presetBox.addItem (presets.getName (i), i + 1);
+
+        presetBox.addSeparator();
+        presetBox.addItem ("Save as new preset", saveItemId());
+    }
+
+    int saveItemId() const noexcept     { return presets.getNumPresets() + 1; }
+
+    /// The whole sound changes at once, at the audio thread's next block.
+    void selectPreset (int index)
+    {
+        if (! isPositiveAndBelow (index, presets.getNumPresets()))
+            return;
+
+        patch = presets.getPatch (index);
+        synthAudioSource.setPatch (patch);
+
+        waveformBlend.setValue (patch.morph * waveformBlend.getMaximum(), dontSendNotification);
+        morphLfoDepth.setValue (patch.modulation.getRoute (ModSource::lfo, ModDestination::morph), dontSendNotification);
+        noiseMix.setValue (patch.modulation.noise.mix, dontSendNotification);
+        noiseColourBox.setSelectedId ((int) patch.modulation.noise.colour + 1, dontSendNotification);
+        spectralMorphToggle.setToggleState (patch.modulation.morphMode == MorphMode::spectral, dontSendNotification);
+        oscillatorModeBox.setSelectedId ((int) patch.modulation.oscillatorMode + 1, dontSendNotification);
+        vectorToggle.setToggleState (patch.modulation.vector.enabled, dontSendNotification);
+        showVectorPad();
+    }
+
+    /// The pad takes the waveform slider's place while the vector morph is on.
+    void showVectorPad()
+    {
+        vectorPad.setPosition ({ patch.morph, patch.morphY });
+        vectorPad.setVisible (patch.modulation.vector.enabled);
+        waveformBlend.setVisible (! patch.modulation.vector.enabled);
+    }
+
+    void saveNewPreset()
+    {
+        presets.add ("Preset " + String (presets.getNumPresets()), patch);
+        presets.saveTo (getPresetFile());
+        updatePresetBox();
+        presetBox.setSelectedId (presets.getNumPresets(), dontSendNotification);
+    }
+
+    /// With MIDI learn on, touching a slider makes it the parameter the next
+    /// controller that moves gets bound to.
+    void armMidiLearn (int parameter)
+    {
+        if (midiLearnToggle.getToggleState())
+            synthAudioSource.synth.midiMapping.startLearning (parameter);
+    }
+
+    /// Plays one table of the compressed library, building the library the
+    /// first time. Its mips are decoded in the background, so the first notes
+    /// may sound duller until the richer levels arrive.
+    void selectLibraryTable (int index)
+    {
+        if (! isPositiveAndBelow (index, numLibraryTables))
+            return;
+
+        if (compressedLibrary == nullptr)
+        {
+            compressedLibrary = std::make_unique<CompressedWavetableBank> (synthAudioSource.wavetables);
+
+            for (int i = 0; i < numLibraryTables; ++i)
+                compressedLibrary->addHarmonicSweep (CompressedWavetableBank::defaultFramesPerTable, i + 1);
+        }
+
+        // Any wavetable file still loading is now out of date
+        wavetableIndex = -1;
+
+        auto sampleRate = synthAudioSource.synth.getSampleRate();
+        compressedLibrary->prefetch (index, sampleRate > 0.0 ? sampleRate : 44100.0);
+        synthAudioSource.loadWavetables (compressedLibrary->getTable (index));
+    }
+
+    void selectWavetable (int index)
+    {
+        if (! isPositiveAndBelow (index, wavetableFiles.size()))
+            return;
+
+        libraryBox.setSelectedId (0, dontSendNotification);
+
+        wavetableIndex = index;
+
+        // A slow miss can finish after a later pick was a hit: only the table still selected is played
+        wavetableCache.select (wavetableFiles, index, 2, [this, index, file = wavetableFiles[index]] (WavetableSet::Ptr tables)
+        {
+            if (tables != nullptr && index == wavetableIndex && file == wavetableFiles[wavetableIndex])
+                synthAudioSource.loadWavetables (tables);
+        });
     }
 
 private:
+    void timerCallback() override
+    {
+        ThreadTuning::keepOffRealtimeCores();
+
+        // Polled quickly while learning, so the binding shows up as soon as a controller moves
+        if (synthAudioSource.synth.midiMapping.updateLearning())
+            midiLearnToggle.setToggleState (false, dontSendNotification);
+
+        if (! midiLearnToggle.getToggleState() && getTimerInterval() != 1000)
+            startTimer (1000);
+
+       #ifndef JUCE_DEMO_RUNNER
+        auto suspendAfter = synthAudioSource.settings.suspendAfterIdleSeconds;
+
+        if (suspendAfter > 0.0 && ! deviceSuspended && synthAudioSource.getIdleSeconds() >= suspendAfter)
+        {
+            deviceSuspended = true;
+            audioDeviceManager.closeAudioDevice();
+        }
+       #endif
+
+        auto status = deviceSuspended ? String ("Audio device suspended until the next note")
+                                      : synthAudioSource.getStatusReport();
+
+        if (compressedLibrary != nullptr)
+            status << "; library " << (int) (compressedLibrary->getCompressedBytes() >> 20) << " MB compressed + "
+                   << (int) (compressedLibrary->getResidentBytes() >> 20) << " MB decoded (float: "
+                   << (int) (compressedLibrary->getUncompressedBytes() >> 20) << " MB)";
+
+        statusLabel.setText (status, dontSendNotification);
+    }
+
+    /// MIDI input thread. While the device is suspended, messages are held
+    /// back, because reopening it resets the collector.
+    void handleIncomingMidiMessage (MidiInput* source, const MidiMessage& message) override
+    {
+        if (deviceSuspended)
+        {
+            {
+                const ScopedLock sl (heldMidiLock);
+                heldMidi.add (message);
+            }
+
+            triggerAsyncUpdate();
+            return;
+        }
+
+        synthAudioSource.midiCollector.handleIncomingMidiMessage (source, message);
+    }
+
+    /// On-screen keyboard notes wake the device too. The audio thread calls this
+    /// as well, but never while the device is suspended.
+    void handleNoteOn (MidiKeyboardState*, int, int, float) override
+    {
+        if (deviceSuspended)
+            triggerAsyncUpdate();
+    }
+
+    void handleNoteOff (MidiKeyboardState*, int, int, float) override {}
+
+    /// Reopens the suspended device, then replays the MIDI that woke it.
+    void handleAsyncUpdate() override
+    {
+        if (! deviceSuspended)
+            return;
+
+        audioDeviceManager.restartLastAudioDevice();
+        deviceSuspended = false;
+
+        Array<MidiMessage> messages;
+        {
+            const ScopedLock sl (heldMidiLock);
+            messages.swapWith (heldMidi);
+        }
+
+        for (auto message : messages)
+        {
+            message.setTimeStamp (Time::getMillisecondCounterHiRes() * 0.001);
+            synthAudioSource.midiCollector.addMessageToQueue (message);
+        }
+    }
+
    #ifndef JUCE_DEMO_RUNNER
     AudioDeviceManager audioDeviceManager;
    #else
@@ -158,10 +818,35 @@ private:
     SynthAudioSource synthAudioSource        { keyboardState };
     MidiKeyboardComponent keyboardComponent  { keyboardState, MidiKeyboardComponent::horizontalKeyboard};
 
-    Label waveformBlendLabel;
+    Label waveformBlendLabel, morphLfoLabel, noiseMixLabel, statusLabel;
+    Slider morphLfoDepth, noiseMix;
+    ToggleButton renderAheadToggle { "Render ahead" }, midiLearnToggle { "MIDI learn" }, spectralMorphToggle { "Spectral" },
+                 vectorToggle { "Vector XY" };
+    OwnedArray<ToggleButton> effectToggles;
     Slider waveformBlend;
+    VectorPad vectorPad;
+
+    TextButton loadWavetableButton { "Wavetable..." }, previousWavetableButton { "<" }, nextWavetableButton { ">" };
+    std::unique_ptr<FileChooser> wavetableChooser;
+    TextButton loadTuningButton { "Tuning..." };
+    std::unique_ptr<FileChooser> tuningChooser;
+    ComboBox presetBox, oscillatorModeBox, noiseColourBox, libraryBox;
+    PresetBank presets;
+    Patch patch;
+    WavetableImporter wavetableImporter;
+    WavetableCache wavetableCache { *synthAudioSource.store, 256 * 1024 * 1024,
+                                    [this] (const File& file) { return wavetableImporter.import (file); } };
+    Array<File> wavetableFiles;
+    int wavetableIndex = -1;
+
+    static constexpr int numLibraryTables = 16;
+    std::unique_ptr<CompressedWavetableBank> compressedLibrary;
 
     Callback callback { audioSourcePlayer };
 
+    std::atomic<bool> deviceSuspended { false };
+    CriticalSection heldMidiLock;
+    Array<MidiMessage> heldMidi;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioSynthesiserDemo)
 };
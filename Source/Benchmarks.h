@@ -0,0 +1,656 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+    Created:    17 Oct 2026 2:36:55pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include "CompressedWavetableBank.h"
+#include "MorphSynth.h"
+#include "WavetableLibrary.h"
+
+/// Micro-benchmarks for the synth engine, run headless with
+///     MorphingOscillatorDemo --benchmark <name>
+/// Results are printed to stdout and the app quits afterwards.
+struct Benchmarks
+{
+    /// Returns true if the command line asked for a benchmark (which has then been run).
+    static bool runFromCommandLine (const String& commandLine)
+    {
+        if (! commandLine.contains ("--benchmark"))
+            return false;
+
+        auto name = commandLine.fromFirstOccurrenceOf ("--benchmark", false, false)
+                               .trim()
+                               .upToFirstOccurrenceOf (" ", false, false);
+
+        if (name.isEmpty() || name == "tables")
+            runTableLookup();
+        else if (name == "compressed")
+            runCompressedLibrary();
+        else if (name == "modulation")
+            runModulation();
+        else if (name == "matrix")
+            runMatrix();
+        else if (name == "fm")
+            runFm();
+        else if (name == "sync")
+            runSync();
+        else if (name == "filter")
+            runFilter();
+        else if (name == "pitch")
+            runPitch();
+        else if (name == "controllers")
+            runControllers();
+        else if (name == "presets")
+            runPresets();
+        else if (name == "spectral")
+            runSpectral();
+        else if (name == "additive")
+            runAdditive();
+        else if (name == "kernels")
+            runKernels();
+        else if (name == "vector")
+            runVector();
+        else if (name == "noise")
+            runNoise();
+        else
+            std::cout << "Unknown benchmark: " << name.toRawUTF8() << std::endl;
+
+        return true;
+    }
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 256;
+
+    /// What measureVoice() plays: one held note per voice under a patch, plus
+    /// whatever the hooks add.
+    struct VoiceRun
+    {
+        VoiceRun (WavetablePublisher& publisherToUse, int voices = 1)
+            : publisher (&publisherToUse), numVoices (voices) {}
+
+        WavetablePublisher* publisher;
+        int numVoices;
+        Patch patch;
+        MidiBuffer midiPerBlock;                                    // sent again with every block
+        std::function<void (MorphSynth&)> setup;                    // once, before prepare(), e.g. to bind controllers
+        std::function<void (MorphSynth&, int)> beforeBlock;         // ahead of every block, with its index
+    };
+
+    /// Measures a baseline run, then variants of it against that baseline,
+    /// printing one "label: ns/sample per voice (ratio)" line for each.
+    class Comparison
+    {
+    public:
+        Comparison (const VoiceRun& baselineToUse, const String& label)
+            : baseline (baselineToUse),
+              nanoseconds (measureVoice (baseline))
+        {
+            std::cout << label.toRawUTF8() << ": " << nanoseconds << " ns/sample per voice" << std::endl;
+        }
+
+        /// Measures the baseline as modified by `change`, and returns its ns/sample per voice.
+        double measure (const String& label, const std::function<void (VoiceRun&)>& change) const
+        {
+            auto run = baseline;
+            change (run);
+
+            auto result = measureVoice (run);
+            std::cout << label.toRawUTF8() << ": " << result << " ns/sample per voice ("
+                      << result / nanoseconds << "x)" << std::endl;
+            return result;
+        }
+
+    private:
+        const VoiceRun baseline;
+        const double nanoseconds;
+    };
+
+    /// Random-access wavetable reads from a large library, once per page backing.
+    /// Each simulated voice jumps to a random entry, frame and mip every 64
+    /// samples, which is what a busy multi-voice patch with modulated morphs
+    /// looks like to the TLB.
+    static void runTableLookup (int numEntries = 256, int framesPerEntry = 16)
+    {
+        constexpr int tableSize = WavetableSet::defaultTableSize;
+        constexpr int samplesPerJump = 64;
+        constexpr int numJumps = 1 << 18;
+
+        for (auto requested : { TableMemory::Backing::standardPages,
+                                TableMemory::Backing::transparentHugePages,
+                                TableMemory::Backing::explicitHugePages })
+        {
+            WavetableLibrary library (numEntries, framesPerEntry, tableSize, requested);
+
+            for (int entry = 0; entry < numEntries; ++entry)
+            {
+                auto& set = library.getEntryUnchecked (entry);
+
+                for (int frame = 0; frame < framesPerEntry; ++frame)
+                    for (int mip = 0; mip < set.getNumMips(); ++mip)
+                        FloatVectorOperations::fill (set.getWritePointer (frame, mip),
+                                                     (float) (entry + frame + mip) * 1.0e-4f, tableSize + 1);
+            }
+
+            Random random (1234);
+            double phase = 0.0;
+            float sum = 0.0f;
+
+            auto start = Time::getHighResolutionTicks();
+
+            for (int jump = 0; jump < numJumps; ++jump)
+            {
+                auto& set = library.getEntryUnchecked (random.nextInt (numEntries));
+                auto* table = set.getTable (random.nextInt (framesPerEntry), random.nextInt (set.getNumMips()));
+                auto increment = 0.5 + random.nextDouble() * 40.0;
+
+                for (int i = 0; i < samplesPerJump; ++i)
+                {
+                    auto index = (int) phase;
+                    auto frac = (float) (phase - index);
+                    sum += table[index] + frac * (table[index + 1] - table[index]);
+
+                    phase += increment;
+                    if (phase >= tableSize)
+                        phase -= tableSize;
+                }
+            }
+
+            auto seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+            auto nsPerLookup = seconds * 1.0e9 / ((double) numJumps * samplesPerJump);
+
+            std::cout << "requested " << TableMemory::getBackingName (requested).toRawUTF8()
+                      << ", got " << TableMemory::getBackingName (library.getBacking()).toRawUTF8()
+                      << ": " << (library.getNumBytes() >> 20) << " MB, "
+                      << nsPerLookup << " ns/lookup"
+                      << " (checksum " << sum << ")" << std::endl;
+        }
+    }
+
+    /// A library of 256-frame tables kept compressed, against the same tables
+    /// as a float WavetableLibrary: the memory each keeps resident, then what
+    /// voices sweeping the morph across one table cost on the audio thread once
+    /// its mips have been decoded.
+    static void runCompressedLibrary (int numTables = 64)
+    {
+        constexpr int numFrames = CompressedWavetableBank::defaultFramesPerTable;
+
+        WavetableStore store;
+        WavetablePublisher compressedPublisher (store, store.getClassicShapes());
+        CompressedWavetableBank bank (compressedPublisher);
+
+        for (int i = 0; i < numTables; ++i)
+            bank.addHarmonicSweep (numFrames, i + 1);
+
+        std::cout << numTables << " tables of " << numFrames << " frames: "
+                  << (bank.getCompressedBytes() >> 20) << " MB compressed + "
+                  << (bank.getResidentBytes() >> 20) << " MB decode pool, against "
+                  << (bank.getUncompressedBytes() >> 20) << " MB as float" << std::endl;
+
+        // The float library only holds the table that is played; the sizes above are for all of them
+        WavetableLibrary library (1, numFrames);
+        {
+            constexpr int tableSize = WavetableSet::defaultTableSize;
+            auto frames = CompressedWavetableBank::createHarmonicSweep (numFrames, tableSize, 1);
+
+            for (int frame = 0; frame < numFrames; ++frame)
+                WavetableBuilder::buildMips (library.getEntryUnchecked (0), frame, frames + (size_t) frame * (tableSize + 1));
+        }
+
+        bank.prefetch (0, sampleRate);
+
+        while (! bank.isReady (0, sampleRate))
+            Thread::sleep (10);
+
+        compressedPublisher.publish (bank.getTable (0));
+        WavetablePublisher floatPublisher (store, library.getEntry (0));
+
+        VoiceRun floatTables { floatPublisher, 8 };
+        floatTables.patch.modulation.oscillatorMode = OscillatorMode::wavetable;
+        floatTables.patch.modulation.lfoRateHz = 2.0;
+        floatTables.patch.modulation.setRoute (ModSource::lfo, ModDestination::morph, 1.0f);
+
+        const Comparison compare (floatTables, "float library");
+        compare.measure ("compressed library, decoded", [&compressedPublisher] (VoiceRun& run) { run.publisher = &compressedPublisher; });
+    }
+
+    /// One voice with the LFO and mod envelope driving morph, pitch and level
+    /// at once, at several control intervals down to audio rate.
+    static void runModulation()
+    {
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+        const Comparison compare ({ publisher }, "no routes");
+
+        for (auto interval : { 64, 32, 16, 1 })
+        {
+            compare.measure ("all routes, every " + String (interval) + " samples", [interval] (VoiceRun& run)
+            {
+                auto& heavy = run.patch.modulation;
+                heavy.lfoRateHz = 5.0;
+                heavy.controlInterval = interval;
+                heavy.setRoute (ModSource::lfo, ModDestination::morph, 0.5f);
+                heavy.setRoute (ModSource::lfo, ModDestination::pitch, 0.3f);
+                heavy.setRoute (ModSource::lfo, ModDestination::level, 0.2f);
+                heavy.setRoute (ModSource::modEnvelope, ModDestination::morph, 0.3f);
+                heavy.setRoute (ModSource::modEnvelope, ModDestination::pitch, 2.0f);
+            });
+        }
+    }
+
+    /// Phase modulation at a few indices, with and without band-limiting,
+    /// relative to the plain morph voice.
+    static void runFm()
+    {
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+        const Comparison compare ({ publisher }, "plain morph");
+
+        for (auto bandLimit : { FmParameters::BandLimit::none, FmParameters::BandLimit::carsonsRule })
+        {
+            for (auto index : { 0.5f, 2.0f, 8.0f })
+            {
+                compare.measure ("index " + String (index) + (bandLimit == FmParameters::BandLimit::none ? ", no band-limiting" : ", Carson's rule"),
+                                 [=] (VoiceRun& run)
+                                 {
+                                     run.patch.modulation.fm.ratio = 2.0f;
+                                     run.patch.modulation.fm.index = index;
+                                     run.patch.modulation.fm.bandLimit = bandLimit;
+                                 });
+            }
+        }
+    }
+
+    /// Per-voice cost of hard sync at a few slave pitches, relative to the
+    /// plain morph voice. There is one restart (and BLEP) per cycle of the
+    /// note, so most of the extra cost is the scalar phase loop.
+    static void runSync()
+    {
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+        const Comparison compare ({ publisher }, "plain morph");
+
+        for (auto semitones : { 0.0f, 12.0f, 31.0f, 48.0f })
+        {
+            compare.measure ("synced " + String (semitones) + " semitones above", [semitones] (VoiceRun& run)
+            {
+                run.patch.modulation.sync.enabled = true;
+                run.patch.modulation.sync.semitones = semitones;
+            });
+        }
+    }
+
+    /// Sixteen voices through the SIMD filter bank, with fixed coefficients and
+    /// with an LFO on the cutoff (new coefficients every tick), per voice.
+    static void runFilter()
+    {
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+        const Comparison compare ({ publisher, 16 }, "unfiltered");
+
+        auto filtered = [] (VoiceRun& run)
+        {
+            run.patch.modulation.filter.enabled = true;
+            run.patch.modulation.filter.resonance = 0.7f;
+        };
+
+        compare.measure ("filtered, fixed cutoff", filtered);
+        compare.measure ("filtered, swept cutoff", [&filtered] (VoiceRun& run)
+        {
+            filtered (run);
+            run.patch.modulation.lfoRateHz = 3.0;
+            run.patch.modulation.setRoute (ModSource::lfo, ModDestination::cutoff, 24.0f);
+        });
+    }
+
+    /// Voices whose pitch moves continuously (an LFO on pitch, like a wobbling
+    /// bend, plus a glide between every note) against voices held still.
+    static void runPitch()
+    {
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+        const Comparison compare ({ publisher, 8 }, "fixed pitch");
+
+        for (auto interval : { 32, 1 })
+        {
+            compare.measure ("bending and gliding, new pitch every " + String (interval) + " samples", [interval] (VoiceRun& run)
+            {
+                auto& bending = run.patch.modulation;
+                bending.lfoRateHz = 6.0;
+                bending.glideSeconds = 60.0;
+                bending.controlInterval = interval;
+                bending.setRoute (ModSource::lfo, ModDestination::pitch, 0.5f);
+            });
+        }
+    }
+
+    /// A 14-bit CC mapped to the morph, swept in steps every few samples. Each
+    /// step splits the block and re-aims every voice's ramps at that sample.
+    static void runControllers()
+    {
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+        const Comparison compare ({ publisher, 8 }, "no controllers");
+
+        for (auto spacing : { 64, 16, 4 })
+        {
+            compare.measure ("morph moved every " + String (spacing) + " samples", [spacing] (VoiceRun& run)
+            {
+                run.setup = [] (MorphSynth& synth)
+                {
+                    synth.midiMapping.bind (MidiMapping::morphParameter, { MidiController::Type::controller14Bit, 1, 1 });
+                };
+
+                for (int position = 0; position < blockSize; position += spacing)
+                {
+                    auto value = (position * 16383) / blockSize;
+                    run.midiPerBlock.addEvent (MidiMessage::controllerEvent (1, 1, value >> 7), position);
+                    run.midiPerBlock.addEvent (MidiMessage::controllerEvent (1, 33, value & 0x7f), position);
+                }
+            });
+        }
+    }
+
+    /// A different preset, out of a bank of a thousand random ones, before every
+    /// block, against a patch left alone.
+    static void runPresets()
+    {
+        constexpr int numPresets = 1000;
+
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+
+        PresetBank bank;
+        Random random (1);
+
+        for (int i = 0; i < numPresets; ++i)
+        {
+            Patch patch;
+            patch.morph = random.nextDouble();
+            patch.level = 0.5 + 0.5 * random.nextDouble();
+            patch.modulation.lfoRateHz = 0.1 + 10.0 * random.nextDouble();
+            patch.modulation.filter.enabled = random.nextBool();
+            patch.modulation.filter.cutoffHz = 200.0f + 8000.0f * random.nextFloat();
+            patch.modulation.setRoute (ModSource::lfo, ModDestination::morph, random.nextFloat());
+            patch.modulation.setRoute (ModSource::modEnvelope, ModDestination::cutoff, 24.0f * random.nextFloat());
+
+            // Through the ValueTree, as a loaded bank would be
+            bank.add ("Random " + String (i), PresetBank::compile (PresetBank::toValueTree (patch)));
+        }
+
+        const Comparison compare ({ publisher, 8 }, "one patch");
+
+        compare.measure ("new preset every block", [&bank] (VoiceRun& run)
+        {
+            run.beforeBlock = [&bank] (MorphSynth& synth, int block) { synth.setPatch (bank.getPatch (block % bank.getNumPresets())); };
+        });
+    }
+
+    /// How long the background thread takes to resynthesise the spectral frames
+    /// of the classic shapes, and what playing them costs against the plain set.
+    static void runSpectral()
+    {
+        constexpr int numBuilds = 5;
+
+        WavetableStore store;
+        auto shapes = store.getClassicShapes();
+        WavetableSet::Ptr frames;
+
+        auto start = Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numBuilds; ++i)
+            frames = SpectralMorph::createFrames (*shapes);
+
+        auto seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+        std::cout << frames->getNumWaves() << " frames x " << frames->getNumMips() << " mips: "
+                  << seconds * 1000.0 / numBuilds << " ms to build, "
+                  << frames->getNumBytes() / 1024 << " KB" << std::endl;
+
+        WavetablePublisher plainPublisher (store, shapes), framesPublisher (store, frames);
+
+        for (auto lfoDepth : { 0.0f, 1.0f })
+        {
+            VoiceRun plain { plainPublisher, 8 };
+            plain.patch.modulation.lfoRateHz = 2.0;
+            plain.patch.modulation.setRoute (ModSource::lfo, ModDestination::morph, lfoDepth);
+
+            const String morph (lfoDepth > 0.0f ? "swept morph" : "fixed morph");
+            const Comparison compare (plain, morph + ", crossfade");
+            compare.measure (morph + ", spectral", [&framesPublisher] (VoiceRun& run) { run.publisher = &framesPublisher; });
+        }
+    }
+
+    /// The additive sine bank against the table kernel, from the middle of the
+    /// keyboard (many harmonics) up to the top (only a few below Nyquist).
+    static void runAdditive()
+    {
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+
+        // Velocity 1 into pitch moves the benchmark's notes up by the route depth
+        for (auto semitones : { 0.0f, 24.0f, 36.0f, 48.0f })
+        {
+            auto numPartials = SineBank::getNumPartials (FastMath::pitchToIncrement (48.0f + semitones, sampleRate));
+            const String notes ("notes " + String (semitones) + " semitones up, " + String (numPartials) + " partials");
+
+            VoiceRun tables { publisher, 8 };
+            tables.patch.modulation.oscillatorMode = OscillatorMode::wavetable;
+            tables.patch.modulation.setRoute (ModSource::velocity, ModDestination::pitch, semitones);
+
+            const Comparison compare (tables, notes + ", tables");
+            compare.measure (notes + ", additive", [] (VoiceRun& run) { run.patch.modulation.oscillatorMode = OscillatorMode::additive; });
+        }
+    }
+
+    /// Automatic kernel selection against always reading the tables, with the
+    /// morph resting on each of the classic shapes and half way between two,
+    /// from low notes to high ones. Prints which kernels the voices settled on.
+    static void runKernels()
+    {
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+
+        for (auto morph : { 0.0, 1.0 / 3.0, 2.0 / 3.0, 1.0, 1.0 / 6.0 })
+        {
+            // Velocity 1 into pitch moves the benchmark's notes by the route depth
+            for (auto semitones : { -24.0f, 0.0f, 48.0f })
+            {
+                const String position ("morph " + String (morph, 2) + ", notes " + String (semitones) + " semitones");
+
+                VoiceRun tables { publisher, 8 };
+                tables.patch.morph = morph;
+                tables.patch.modulation.oscillatorMode = OscillatorMode::wavetable;
+                tables.patch.modulation.setRoute (ModSource::velocity, ModDestination::pitch, semitones);
+
+                String kernels;
+                const Comparison compare (tables, position + ", tables");
+                compare.measure (position + ", automatic", [&kernels] (VoiceRun& run)
+                {
+                    run.patch.modulation.oscillatorMode = OscillatorMode::automatic;
+                    run.beforeBlock = [&kernels] (MorphSynth& synth, int block)
+                    {
+                        if (block == 1)
+                            kernels = synth.getKernelUsage().describe();
+                    };
+                });
+
+                std::cout << "    " << kernels.toRawUTF8() << std::endl;
+            }
+        }
+    }
+
+    /// The four-corner vector morph against the plain two-wave crossfade, both
+    /// with the LFO sweeping every axis, on the tables either way.
+    static void runVector()
+    {
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+
+        VoiceRun crossfade { publisher, 8 };
+        auto& modulation = crossfade.patch.modulation;
+        modulation.oscillatorMode = OscillatorMode::wavetable;
+        modulation.lfoRateHz = 2.0;
+        modulation.setRoute (ModSource::lfo, ModDestination::morph, 0.5f);
+        modulation.setRoute (ModSource::lfo, ModDestination::morphY, 0.5f);
+
+        const Comparison compare (crossfade, "two waves");
+        compare.measure ("four corners", [] (VoiceRun& run) { run.patch.modulation.vector.enabled = true; });
+    }
+
+    /// The noise generator on its own against juce::Random one sample at a
+    /// time, then whole voices crossfading half way into each colour of noise.
+    static void runNoise()
+    {
+        constexpr int numBlocks = 100000;
+
+        HeapBlock<float> samples (blockSize);
+        NoiseSource noise;
+        noise.seed (1);
+        Random random (1);
+        float sum = 0.0f;
+
+        auto start = Time::getHighResolutionTicks();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int i = 0; i < blockSize; ++i)
+                samples[i] = random.nextFloat() * 2.0f - 1.0f;
+
+            sum += samples[block % blockSize];
+        }
+
+        auto randomNs = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start) * 1.0e9 / (numBlocks * blockSize);
+        start = Time::getHighResolutionTicks();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            noise.render (NoiseParameters::Colour::white, samples, blockSize);
+            sum += samples[block % blockSize];
+        }
+
+        auto noiseNs = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start) * 1.0e9 / (numBlocks * blockSize);
+        std::cout << "juce::Random: " << randomNs << " ns/sample, NoiseSource: " << noiseNs
+                  << " ns/sample (" << randomNs / noiseNs << "x faster, checksum " << sum << ")" << std::endl;
+
+        // The same seed must give the same stream however the blocks are split
+        HeapBlock<float> whole (blockSize), split (blockSize);
+        noise.seed (7);
+        noise.render (NoiseParameters::Colour::pink, whole, blockSize);
+        noise.seed (7);
+
+        for (int done = 0, length = 1; done < blockSize; done += length, length += 2)
+        {
+            length = jmin (length, blockSize - done);
+            noise.render (NoiseParameters::Colour::pink, split + done, length);
+        }
+
+        std::cout << "split blocks repeat the stream: " << (std::equal (whole.get(), whole.get() + blockSize, split.get()) ? "yes" : "NO") << std::endl;
+
+        WavetableStore store;
+        WavetablePublisher publisher (store, store.getClassicShapes());
+        const Comparison compare ({ publisher, 8 }, "no noise");
+
+        static const char* const colourNames[] = { "white", "pink", "brown" };
+
+        for (int colour = 0; colour <= (int) NoiseParameters::Colour::brown; ++colour)
+        {
+            compare.measure (String (colourNames[colour]) + " noise at half mix", [colour] (VoiceRun& run)
+            {
+                run.patch.modulation.noise.mix = 0.5f;
+                run.patch.modulation.noise.colour = (NoiseParameters::Colour) colour;
+            });
+        }
+    }
+
+    /// One matrix evaluation for a full set of voices, adding one route at a
+    /// time until every source drives every destination.
+    static void runMatrix()
+    {
+        constexpr int numVoices = 64;
+        constexpr int numTicks = 200000;
+
+        ModulationMatrix matrix;
+        RealtimeArena sizing, arena;
+        matrix.prepare (sizing, numVoices);
+        arena.reserve (sizing.getBytesUsed(), false);
+        matrix.prepare (arena, numVoices);
+
+        Random random (1);
+        for (int s = 0; s < numModSources; ++s)
+            for (int v = 0; v < numVoices; ++v)
+                matrix.setSource ((ModSource) s, v, random.nextFloat());
+
+        ModulationParameters parameters;
+        float sum = 0.0f;
+
+        for (int numRoutes = 0; numRoutes <= numModSources * numModDestinations; ++numRoutes)
+        {
+            if (numRoutes > 0)
+                parameters.routes[(numRoutes - 1) % numModDestinations][(numRoutes - 1) / numModDestinations] = 0.1f * (float) numRoutes;
+
+            auto start = Time::getHighResolutionTicks();
+
+            for (int tick = 0; tick < numTicks; ++tick)
+            {
+                matrix.process (parameters, numVoices);
+                sum += matrix.getDestination (ModDestination::morph, tick % numVoices);
+            }
+
+            auto seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+            std::cout << numRoutes << " routes, " << numVoices << " voices: "
+                      << seconds * 1.0e9 / numTicks << " ns/tick" << std::endl;
+        }
+
+        std::cout << "(checksum " << sum << ")" << std::endl;
+    }
+
+    /// Holds one note per voice and returns the cost per sample and voice.
+    static double measureVoice (const VoiceRun& run)
+    {
+        constexpr int numBlocks = 4000;
+
+        MorphSynth synth;
+
+        for (int i = 0; i < run.numVoices; ++i)
+            synth.addVoice (new MorphingWaveformVoice (*run.publisher));
+
+        synth.addSound (new MorphingWaveformSound());
+        synth.setPatch (run.patch);
+
+        if (run.setup)
+            run.setup (synth);
+
+        synth.setCurrentPlaybackSampleRate (sampleRate);
+
+        RealtimeArena sizing, arena;
+        synth.prepare (sizing, blockSize, sampleRate);
+        arena.reserve (sizing.getBytesUsed(), false);
+        synth.prepare (arena, blockSize, sampleRate);
+
+        AudioBuffer<float> buffer (2, blockSize);
+
+        for (int i = 0; i < run.numVoices; ++i)
+            synth.noteOn (1, 48 + i, 1.0f);
+
+        auto start = Time::getHighResolutionTicks();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            if (run.beforeBlock)
+                run.beforeBlock (synth, block);
+
+            buffer.clear();
+            synth.renderNextBlock (buffer, run.midiPerBlock, 0, blockSize);
+        }
+
+        auto seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+        return seconds * 1.0e9 / ((double) numBlocks * blockSize * run.numVoices);
+    }
+};
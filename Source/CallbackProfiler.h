@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    CallbackProfiler.h
+    Created:    17 Oct 2026 6:12:40pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+
+/// CallbackProfiler times a piece of realtime work (a whole audio callback or
+/// one stage of it) into a histogram, so the message thread can read tail
+/// latencies rather than just an average.
+///
+/// The audio thread is the only writer and never blocks or allocates; the
+/// message thread reads a snapshot with getStatistics() whenever it likes.
+/// Wrap the work in a ScopedMeasurement, or call begin() and end() by hand.
+class CallbackProfiler
+{
+public:
+    /// 2 us resolution up to ~8 ms; anything slower lands in the last bucket
+    /// (the exact maximum is kept separately).
+    static constexpr double bucketMicroseconds = 2.0;
+    static constexpr int numBuckets = 4096;
+
+    struct Statistics
+    {
+        int64 numCallbacks = 0, numOverruns = 0;
+        double meanMicroseconds = 0.0, p50Microseconds = 0.0, p99Microseconds = 0.0,
+               p999Microseconds = 0.0, maxMicroseconds = 0.0, budgetMicroseconds = 0.0;
+
+        String toString() const
+        {
+            return String (p50Microseconds, 0) + " / " + String (p99Microseconds, 0) + " / "
+                 + String (p999Microseconds, 0) + " / " + String (maxMicroseconds, 0)
+                 + " us (p50/p99/p99.9/max) of " + String (budgetMicroseconds, 0) + " us, "
+                 + String (numOverruns) + " overruns in " + String (numCallbacks);
+        }
+    };
+
+    struct ScopedMeasurement
+    {
+        ScopedMeasurement (CallbackProfiler& p, int numSamplesIn) noexcept
+            : profiler (p), numSamples (numSamplesIn), start (p.begin()) {}
+
+        ~ScopedMeasurement() noexcept   { profiler.end (start, numSamples); }
+
+        CallbackProfiler& profiler;
+        const int numSamples;
+        const int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedMeasurement)
+    };
+
+    CallbackProfiler()
+        : microsecondsPerTick (1.0e6 / (double) Time::getHighResolutionTicksPerSecond())
+    {
+    }
+
+    /// Call from prepareToPlay: the sample rate defines each block's time budget.
+    void prepare (double sampleRate) noexcept
+    {
+        microsecondsPerSample.store (1.0e6 / sampleRate, std::memory_order_relaxed);
+        reset();
+    }
+
+    /// Any thread: the audio thread clears the counts before its next measurement.
+    void reset() noexcept       { resetRequested.store (true, std::memory_order_release); }
+
+    int64 begin() const noexcept    { return Time::getHighResolutionTicks(); }
+
+    void end (int64 startTicks, int numSamples) noexcept
+    {
+        auto elapsed = (double) (Time::getHighResolutionTicks() - startTicks) * microsecondsPerTick;
+
+        if (resetRequested.exchange (false, std::memory_order_acquire))
+            clear();
+
+        auto bucket = jmin (numBuckets - 1, (int) (elapsed / bucketMicroseconds));
+        increment (buckets[bucket]);
+        increment (numCallbacks);
+
+        if (elapsed > numSamples * microsecondsPerSample.load (std::memory_order_relaxed))
+            increment (numOverruns);
+
+        totalMicroseconds.store (totalMicroseconds.load (std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+        maxMicroseconds.store (jmax (maxMicroseconds.load (std::memory_order_relaxed), elapsed), std::memory_order_relaxed);
+        lastBudgetMicroseconds.store (numSamples * microsecondsPerSample.load (std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    /// Message thread. The percentiles are bucket upper bounds, capped at the maximum.
+    Statistics getStatistics() const
+    {
+        Statistics stats;
+        stats.numCallbacks = numCallbacks.load (std::memory_order_relaxed);
+        stats.numOverruns = numOverruns.load (std::memory_order_relaxed);
+        stats.maxMicroseconds = maxMicroseconds.load (std::memory_order_relaxed);
+        stats.budgetMicroseconds = lastBudgetMicroseconds.load (std::memory_order_relaxed);
+
+        if (stats.numCallbacks == 0)
+            return stats;
+
+        stats.meanMicroseconds = totalMicroseconds.load (std::memory_order_relaxed) / (double) stats.numCallbacks;
+
+        int64 total = 0;
+        for (auto& bucket : buckets)
+            total += bucket.load (std::memory_order_relaxed);
+
+        int64 seen = 0;
+        double* targets[] = { &stats.p50Microseconds, &stats.p99Microseconds, &stats.p999Microseconds };
+        const double fractions[] = { 0.5, 0.99, 0.999 };
+        int next = 0;
+
+        for (int i = 0; i < numBuckets && next < 3; ++i)
+        {
+            seen += buckets[i].load (std::memory_order_relaxed);
+
+            while (next < 3 && (double) seen >= fractions[next] * (double) total)
+                *targets[next++] = jmin ((i + 1) * bucketMicroseconds, stats.maxMicroseconds);
+        }
+
+        return stats;
+    }
+
+private:
+    // Single writer, so a relaxed load and store is enough and cheaper than fetch_add
+    template <typename Counter>
+    static void increment (std::atomic<Counter>& counter) noexcept
+    {
+        counter.store (counter.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void clear() noexcept
+    {
+        for (auto& bucket : buckets)
+            bucket.store (0, std::memory_order_relaxed);
+
+        numCallbacks.store (0, std::memory_order_relaxed);
+        numOverruns.store (0, std::memory_order_relaxed);
+        totalMicroseconds.store (0.0, std::memory_order_relaxed);
+        maxMicroseconds.store (0.0, std::memory_order_relaxed);
+    }
+
+    const double microsecondsPerTick;
+    std::atomic<double> microsecondsPerSample { 1.0e6 / 44100.0 };
+    std::atomic<bool> resetRequested { false };
+
+    std::atomic<uint32> buckets[numBuckets] {};
+    std::atomic<int64> numCallbacks { 0 }, numOverruns { 0 };
+    std::atomic<double> totalMicroseconds { 0.0 }, maxMicroseconds { 0.0 }, lastBudgetMicroseconds { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CallbackProfiler)
+};
@@ -0,0 +1,393 @@
+/*
+  ==============================================================================
+
+    CompressedWavetableBank.h
+    Created:    17 Oct 2026 3:55:13pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <vector>
+#include "ThreadTuning.h"
+#include "WavetablePublisher.h"
+
+/// CompressedWavetableBank keeps a large library of multi-frame wavetables
+/// (256 frames each by default) as 16-bit base frames with one float scale per
+/// frame, and only decodes band-limited mip levels into a bounded pool of
+/// float slots when a voice needs them.
+///
+/// Each table is exposed as a sparse WavetableSet. A background thread
+/// decodes mip levels into pool slots and attaches them to the set; voices
+/// play the nearest attached level and flag missing ones, so the audio thread
+/// never decodes anything. Call prefetch() when a table is selected so the
+/// levels for the playable pitch range are ready before the first note.
+///
+/// Decoded levels are normalised like WavetableBuilder's: every frame is
+/// scaled so its richest level peaks at 1, and the duller ones use the same
+/// gain. The gain is folded into the frame's scale when the table is added.
+///
+/// When the pool is full the least recently played level is detached and its
+/// slot is reused only after the audio thread has passed a block boundary,
+/// so a voice can never read a slot while it is being overwritten. Levels
+/// played since the decoder last looked are never evicted.
+class CompressedWavetableBank final : private Thread
+{
+public:
+    static constexpr int defaultFramesPerTable = 256;
+
+    CompressedWavetableBank (WavetablePublisher& publisherToUse,
+                             int maxResidentMipsToUse = 32,
+                             int maxFramesPerTableToUse = defaultFramesPerTable,
+                             int tableSizeToUse = WavetableSet::defaultTableSize,
+                             TableMemory::Backing backing = TableMemory::Backing::transparentHugePages)
+        : Thread ("Wavetable decoder"),
+          publisher (publisherToUse),
+          tableSize (tableSizeToUse),
+          maxFramesPerTable (maxFramesPerTableToUse),
+          slotFloats (WavetableSet::getStrideFor (tableSizeToUse) * (size_t) maxFramesPerTableToUse),
+          slotPool (new TableMemory (slotFloats * (size_t) maxResidentMipsToUse, backing)),
+          fft ((int) std::log2 (tableSizeToUse)),
+          cycle ((size_t) tableSizeToUse),
+          spectrum ((size_t) tableSizeToUse * 2),
+          work ((size_t) tableSizeToUse * 2)
+    {
+        slots.resize ((size_t) maxResidentMipsToUse);
+
+        for (size_t i = 0; i < slots.size(); ++i)
+            slots[i].data = slotPool->getData() + slotFloats * i;
+
+        startThread (Priority::low);
+    }
+
+    ~CompressedWavetableBank() override
+    {
+        stopThread (4000);
+    }
+
+    /// Encodes numFrames single-cycle frames of tableSize samples and returns
+    /// the new table's index. Not for the audio thread.
+    int addTable (const float* const* frames, int numFrames)
+    {
+        jassert (numFrames > 0 && numFrames <= maxFramesPerTable);
+
+        auto table = std::make_unique<EncodedTable>();
+        table->numFrames = numFrames;
+        table->samples.malloc ((size_t) numFrames * (size_t) tableSize);
+        table->frameScales.malloc ((size_t) numFrames);
+
+        // The decoder's FFT and buffers belong to its thread
+        dsp::FFT encoderFft ((int) std::log2 (tableSize));
+        HeapBlock<float> spectrumBuffer ((size_t) tableSize * 2), workBuffer ((size_t) tableSize * 2), richest ((size_t) tableSize + 1);
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            auto range = FloatVectorOperations::findMinAndMax (frames[frame], tableSize);
+            auto peak = jmax (std::abs (range.getStart()), std::abs (range.getEnd()), 1.0e-9f);
+            auto* dest = table->samples + (size_t) frame * (size_t) tableSize;
+
+            // The gain that makes the richest level peak at 1, as WavetableBuilder::buildMips does
+            WavetableBuilder::forwardTransform (encoderFft, frames[frame], spectrumBuffer, tableSize);
+            WavetableBuilder::writeBandLimited (encoderFft, spectrumBuffer, workBuffer, richest, tableSize, jmax (1, tableSize / 2));
+            auto bandLimited = FloatVectorOperations::findMinAndMax (richest.get(), tableSize);
+            auto bandLimitedPeak = jmax (std::abs (bandLimited.getStart()), std::abs (bandLimited.getEnd()));
+            auto gain = bandLimitedPeak > 0.0f ? 1.0f / bandLimitedPeak : 1.0f;
+
+            table->frameScales[frame] = gain * peak / 32767.0f;
+
+            for (int i = 0; i < tableSize; ++i)
+                dest[i] = (int16) roundToInt (frames[frame][i] * 32767.0f / peak);
+        }
+
+        auto hash = WavetableSet::hashBytes (table->samples, sizeof (int16) * (size_t) numFrames * (size_t) tableSize);
+        hash = WavetableSet::hashBytes (table->frameScales, sizeof (float) * (size_t) numFrames, hash);
+
+        table->set = WavetableSet::createSparse (numFrames, tableSize, slotPool);
+        table->set->sealWithHash (hash);
+
+        const ScopedLock sl (tableLock);
+        tables.push_back (std::move (table));
+        return (int) tables.size() - 1;
+    }
+
+    int getNumTables() const
+    {
+        const ScopedLock sl (tableLock);
+        return (int) tables.size();
+    }
+
+    /// The sparse set for a table, ready to hand to SynthAudioSource::loadWavetables.
+    WavetableSet::Ptr getTable (int index) const
+    {
+        const ScopedLock sl (tableLock);
+        return isPositiveAndBelow (index, (int) tables.size()) ? tables[(size_t) index]->set : nullptr;
+    }
+
+    /// Queues every mip a note between lowestNote and highestNote can use at
+    /// this sample rate for background decoding.
+    void prefetch (int index, double sampleRate, int lowestNote = 0, int highestNote = 127)
+    {
+        auto set = getTable (index);
+
+        if (set != nullptr)
+        {
+            set->requestMips (getMipMask (*set, sampleRate, lowestNote, highestNote));
+            notify();
+        }
+    }
+
+    /// True once every mip prefetch() would ask for with the same arguments is decoded.
+    bool isReady (int index, double sampleRate, int lowestNote = 0, int highestNote = 127) const
+    {
+        auto set = getTable (index);
+
+        if (set == nullptr)
+            return false;
+
+        auto mask = getMipMask (*set, sampleRate, lowestNote, highestNote);
+
+        for (int mip = 0; mip < set->getNumMips(); ++mip)
+            if ((mask & (1u << mip)) != 0 && ! set->isMipResident (mip))
+                return false;
+
+        return true;
+    }
+
+    /// Frames that sweep from a sine to a bright mix of the first 64 harmonics
+    /// picked by `seed`, for demos and benchmarks that need a large library
+    /// without any files: numFrames cycles of tableSize + 1 samples each.
+    static HeapBlock<float> createHarmonicSweep (int numFrames, int tableSize, int seed)
+    {
+        auto numHarmonics = jmin (64, tableSize / 2 - 1);
+        dsp::FFT fft ((int) std::log2 (tableSize));
+        HeapBlock<float> spectrum ((size_t) tableSize * 2, true), work ((size_t) tableSize * 2);
+        HeapBlock<float> weights ((size_t) numHarmonics + 1), phases ((size_t) numHarmonics + 1);
+        HeapBlock<float> frameData ((size_t) numFrames * (size_t) (tableSize + 1));
+        Random random (seed);
+
+        for (int harmonic = 2; harmonic <= numHarmonics; ++harmonic)
+        {
+            weights[harmonic] = random.nextFloat() / (float) harmonic;
+            phases[harmonic] = random.nextFloat() * MathConstants<float>::twoPi;
+        }
+
+        spectrum[2] = 1.0f;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            auto brightness = numFrames > 1 ? (float) frame / (float) (numFrames - 1) : 1.0f;
+
+            for (int harmonic = 2; harmonic <= numHarmonics; ++harmonic)
+            {
+                spectrum[2 * harmonic]     = brightness * weights[harmonic] * std::cos (phases[harmonic]);
+                spectrum[2 * harmonic + 1] = brightness * weights[harmonic] * std::sin (phases[harmonic]);
+            }
+
+            WavetableBuilder::writeBandLimited (fft, spectrum, work, frameData + (size_t) frame * (size_t) (tableSize + 1),
+                                                tableSize, numHarmonics);
+        }
+
+        return frameData;
+    }
+
+    /// Adds createHarmonicSweep()'s frames as a new table. Not for the audio thread.
+    int addHarmonicSweep (int numFrames, int seed)
+    {
+        auto frameData = createHarmonicSweep (numFrames, tableSize, seed);
+        HeapBlock<const float*> frames ((size_t) numFrames);
+
+        for (int frame = 0; frame < numFrames; ++frame)
+            frames[frame] = frameData + (size_t) frame * (size_t) (tableSize + 1);
+
+        return addTable (frames, numFrames);
+    }
+
+    /// Bytes held by the 16-bit base frames.
+    size_t getCompressedBytes() const
+    {
+        const ScopedLock sl (tableLock);
+        size_t total = 0;
+
+        for (auto& table : tables)
+            total += (size_t) table->numFrames * ((size_t) tableSize * sizeof (int16) + sizeof (float));
+
+        return total;
+    }
+
+    /// Bytes of the bounded decode pool.
+    size_t getResidentBytes() const noexcept    { return slotPool->getNumBytes(); }
+
+    /// What the same library would cost with every mip level decoded as float.
+    size_t getUncompressedBytes() const
+    {
+        const ScopedLock sl (tableLock);
+        size_t total = 0;
+
+        for (auto& table : tables)
+            total += WavetableSet::getRequiredFloats (table->numFrames, tableSize) * sizeof (float);
+
+        return total;
+    }
+
+private:
+    struct EncodedTable
+    {
+        int numFrames = 0;
+        HeapBlock<int16> samples;
+        HeapBlock<float> frameScales;
+        WavetableSet::Ptr set;
+    };
+
+    struct Slot
+    {
+        float* data = nullptr;
+        WavetableSet* owner = nullptr;  // the set this slot is attached to, if any
+        int mip = -1;
+        uint64 lastUsed = 0;
+        uint64 detachedAtEpoch = 0;
+        bool awaitingGrace = false;
+    };
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (20);
+            ThreadTuning::keepOffRealtimeCores();
+            service();
+        }
+    }
+
+    /// Every mip a note between lowestNote and highestNote can use, one bit per level.
+    static uint32 getMipMask (const WavetableSet& set, double sampleRate, int lowestNote, int highestNote) noexcept
+    {
+        auto lowestMip  = set.getMipForIncrement (MidiMessage::getMidiNoteInHertz (lowestNote) / sampleRate);
+        auto highestMip = set.getMipForIncrement (MidiMessage::getMidiNoteInHertz (highestNote) / sampleRate);
+        uint32 mask = 0;
+
+        for (int mip = lowestMip; mip <= highestMip; ++mip)
+            mask |= 1u << mip;
+
+        return mask;
+    }
+
+    void service()
+    {
+        ++tick;
+
+        std::vector<EncodedTable*> snapshot;
+        {
+            const ScopedLock sl (tableLock);
+            for (auto& table : tables)
+                snapshot.push_back (table.get());
+        }
+
+        // Every table's usage first, so decoding one table can't evict a level
+        // another table played since the last pass
+        for (auto* table : snapshot)
+        {
+            auto& set = *table->set;
+
+            if (auto used = set.takeUsedMips())
+                for (auto& slot : slots)
+                    if (slot.owner == &set && (used & (1u << slot.mip)) != 0)
+                        slot.lastUsed = tick;
+        }
+
+        for (auto* table : snapshot)
+        {
+            auto& set = *table->set;
+            auto requested = set.takeRequestedMips();
+
+            for (int mip = 0; mip < set.getNumMips() && ! threadShouldExit(); ++mip)
+            {
+                if ((requested & (1u << mip)) == 0 || set.isMipResident (mip))
+                    continue;
+
+                if (! decode (*table, mip))
+                    set.requestMips (1u << mip);    // no slot free yet, try again next pass
+            }
+        }
+    }
+
+    bool decode (EncodedTable& table, int mip)
+    {
+        auto* slot = acquireSlot();
+
+        if (slot == nullptr)
+            return false;
+
+        auto stride = WavetableSet::getStrideFor (tableSize);
+        auto numHarmonics = table.set->getNumHarmonics (mip);
+
+        for (int frame = 0; frame < table.numFrames; ++frame)
+        {
+            auto* source = table.samples + (size_t) frame * (size_t) tableSize;
+            auto scale = table.frameScales[frame];
+
+            for (int i = 0; i < tableSize; ++i)
+                cycle[i] = source[i] * scale;
+
+            WavetableBuilder::forwardTransform (fft, cycle, spectrum, tableSize);
+            WavetableBuilder::writeBandLimited (fft, spectrum, work, slot->data + stride * (size_t) frame, tableSize, numHarmonics);
+        }
+
+        slot->owner = table.set.get();
+        slot->mip = mip;
+        slot->lastUsed = tick;
+        table.set->setMipData (mip, slot->data);
+        return true;
+    }
+
+    Slot* acquireSlot()
+    {
+        auto epoch = publisher.getEpoch();
+        Slot* leastRecent = nullptr;
+
+        for (auto& slot : slots)
+        {
+            if (slot.awaitingGrace && epoch > slot.detachedAtEpoch)
+                slot.awaitingGrace = false;
+
+            if (slot.owner == nullptr && ! slot.awaitingGrace)
+                return &slot;
+
+            // Levels played or decoded during this pass stay
+            if (slot.owner != nullptr && slot.lastUsed < tick
+                 && (leastRecent == nullptr || slot.lastUsed < leastRecent->lastUsed))
+                leastRecent = &slot;
+        }
+
+        // Evict: detach now, reuse once the audio thread has moved past this block
+        if (leastRecent != nullptr)
+        {
+            leastRecent->owner->setMipData (leastRecent->mip, nullptr);
+
+            // Stamped only once the detach is visible: a reader that loaded the
+            // mip before it is still inside a block that ends after this epoch
+            std::atomic_thread_fence (std::memory_order_seq_cst);
+            leastRecent->detachedAtEpoch = publisher.getEpoch();
+            leastRecent->owner = nullptr;
+            leastRecent->mip = -1;
+            leastRecent->awaitingGrace = true;
+        }
+
+        return nullptr;
+    }
+
+    WavetablePublisher& publisher;
+    const int tableSize, maxFramesPerTable;
+    const size_t slotFloats;
+    TableMemory::Ptr slotPool;
+
+    CriticalSection tableLock;
+    std::vector<std::unique_ptr<EncodedTable>> tables;
+
+    // Decoder thread only
+    std::vector<Slot> slots;
+    uint64 tick = 0;
+    dsp::FFT fft;
+    HeapBlock<float> cycle, spectrum, work;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompressedWavetableBank)
+};
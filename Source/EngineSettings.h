@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    EngineSettings.h
+    Created:    17 Oct 2026 9:31:47am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/// EngineSettings collects the deployment-specific knobs of SynthAudioSource.
+/// They are read in prepareToPlay, so changes take effect the next time the
+/// audio device is (re)started.
+struct EngineSettings
+{
+    /// Polyphony. Unlike the rest, this is read once when SynthAudioSource is
+    /// constructed; each voice's scratch memory comes from the realtime arena.
+    int numVoices = 16;
+
+    /// mlock() the realtime arena so it can never be paged out.
+    /// Needs a sufficient RLIMIT_MEMLOCK on Linux; failure is reported, not fatal.
+    bool lockRealtimeMemory = false;
+
+    /// Bytes reserved up front for each MIDI buffer the audio thread fills.
+    size_t midiBufferBytes = 4096;
+
+    enum class RealtimePolicy
+    {
+        inherit,        // keep whatever scheduling the audio device gave its thread
+        fifo,           // SCHED_FIFO
+        roundRobin      // SCHED_RR
+    };
+
+    /// Scheduling class requested for the audio thread and render workers.
+    /// Needs RLIMIT_RTPRIO (the rtprio entry in /etc/security/limits.conf) to
+    /// be at least realtimePriority on Linux; a denial is reported, not fatal.
+    RealtimePolicy realtimePolicy = RealtimePolicy::inherit;
+    int realtimePriority = 70;
+
+    /// Bit n pins the audio thread and render workers to core n; 0 leaves them
+    /// free. The message thread and background loaders are kept off these cores.
+    uint64 realtimeCoreMask = 0;
+
+    /// Ring space reserved for render-ahead playback, in blocks. The depth
+    /// actually used can be changed at runtime up to this limit.
+    int maxRenderAheadBlocks = 8;
+
+    /// Closes the audio device after this long without a sound or an incoming
+    /// event, and reopens it on the next note; 0 keeps it running. Saves the
+    /// most power on embedded hosts, at the cost of the device's restart time
+    /// on the first note.
+    double suspendAfterIdleSeconds = 0.0;
+};
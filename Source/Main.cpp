@@ -8,6 +8,7 @@
 
 #include <JuceHeader.h>
 #include "AudioSynthesiserDemo.h"
+#include "Benchmarks.h"
 
 class Application    : public juce::JUCEApplication
 {
@@ -18,8 +19,14 @@ public:
     const juce::String getApplicationName() override       { return "MorphingOscillatorDemo"; }
     const juce::String getApplicationVersion() override    { return "1.0.0"; }
 
-    void initialise (const juce::String&) override
+    void initialise (const juce::String& commandLine) override
     {
+        if (Benchmarks::runFromCommandLine (commandLine))
+        {
+            quit();
+            return;
+        }
+
         mainWindow.reset (new MainWindow ("MorphingOscillatorDemo", std::make_unique<AudioSynthesiserDemo>(), *this));
     }
 
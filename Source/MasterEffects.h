@@ -0,0 +1,289 @@
+/*
+  ==============================================================================
+
+    MasterEffects.h
+    Created:    17 Oct 2026 11:18:06pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <utility>
+#include "CallbackProfiler.h"
+#include "RealtimeArena.h"
+
+/// FeedbackDelay is a plain echo: each repeat is fed back into the line, and
+/// the repeats are added to the dry signal. The line comes from the realtime
+/// arena, sized for maximumSeconds at the sample rate given to allocate().
+class FeedbackDelay
+{
+public:
+    static constexpr double maximumSeconds = 2.0;
+    static constexpr int numChannels = 2;
+
+    /// Hands out the line from `arena` (which may be a dry run).
+    void allocate (RealtimeArena& arena, double sampleRate)
+    {
+        lineLength = (int) std::ceil (maximumSeconds * sampleRate) + 1;
+
+        for (auto& channel : line)
+            channel = arena.allocate<float> ((size_t) lineLength);
+    }
+
+    void prepare (const dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        delaySamples = jlimit (1, jmax (1, lineLength - 1), roundToInt (delaySeconds * sampleRate));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        writeIndex = 0;
+
+        for (auto* channel : line)
+            if (channel != nullptr)
+                FloatVectorOperations::clear (channel, lineLength);
+    }
+
+    /// Message thread, before prepare().
+    void setParameters (double newDelaySeconds, float newFeedback, float newMix)
+    {
+        delaySeconds = jlimit (0.001, maximumSeconds, newDelaySeconds);
+        feedback = newFeedback;
+        mix = newMix;
+    }
+
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        auto& block = context.getOutputBlock();
+        auto numSamples = (int) block.getNumSamples();
+
+        if (line[0] == nullptr)
+            return;
+
+        for (int channel = 0; channel < jmin (numChannels, (int) block.getNumChannels()); ++channel)
+        {
+            auto* samples = block.getChannelPointer ((size_t) channel);
+            auto* delayLine = line[channel];
+            auto index = writeIndex;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto readIndex = index - delaySamples;
+                auto delayed = delayLine[readIndex < 0 ? readIndex + lineLength : readIndex];
+                delayLine[index] = samples[i] + feedback * delayed;
+                samples[i] += mix * delayed;
+
+                if (++index == lineLength)
+                    index = 0;
+            }
+        }
+
+        writeIndex = (writeIndex + numSamples) % lineLength;
+    }
+
+private:
+    float* line[numChannels] {};
+    int lineLength = 1, writeIndex = 0, delaySamples = 1;
+    double sampleRate = 44100.0, delaySeconds = 0.375;
+    float feedback = 0.4f, mix = 0.35f;
+};
+
+/// MasterEffects runs the mixed voices through chorus, delay, reverb and a
+/// limiter, held in a dsp::ProcessorChain.
+///
+/// The delay line and the crossfade buffers come from the realtime arena; the
+/// JUCE chorus and reverb allocate their own in prepare() (see
+/// getUnpooledBytes()). Nothing allocates after that. Rather than let
+/// the chain process every stage, each one is run by hand so that:
+///  - a bypassed stage that has faded out isn't called at all, so it costs nothing;
+///  - switching a stage crossfades between its input and its output over
+///    fadeSeconds, so toggling never clicks (a stage switched back on is reset
+///    first, so it doesn't replay a stale tail);
+///  - every stage has its own CallbackProfiler.
+class MasterEffects
+{
+public:
+    enum Stage
+    {
+        chorus,
+        delay,
+        reverb,
+        limiter,
+        numStages
+    };
+
+    static constexpr int numChannels = 2;
+    static constexpr double fadeSeconds = 0.02;
+
+    MasterEffects()
+    {
+        auto& chorusStage = chain.get<chorus>();
+        chorusStage.setRate (0.8f);
+        chorusStage.setDepth (0.3f);
+        chorusStage.setMix (0.5f);
+
+        dsp::Reverb::Parameters reverbParameters;
+        reverbParameters.roomSize = 0.6f;
+        reverbParameters.wetLevel = 0.25f;
+        reverbParameters.dryLevel = 0.8f;
+        chain.get<reverb>().setParameters (reverbParameters);
+
+        auto& limiterStage = chain.get<limiter>();
+        limiterStage.setThreshold (-1.0f);
+        limiterStage.setRelease (100.0f);
+    }
+
+    static const char* getStageName (int stage) noexcept
+    {
+        static const char* const names[] = { "Chorus", "Delay", "Reverb", "Limiter" };
+        return names[stage];
+    }
+
+    /// Hands out the delay line and the dry copy used while crossfading from
+    /// `arena` (which may be a dry run).
+    void allocate (RealtimeArena& arena, int blockSizeToUse, double sampleRate)
+    {
+        blockSize = jmax (1, blockSizeToUse);
+
+        for (auto& channel : dry)
+            channel = arena.allocate<float> ((size_t) blockSize);
+
+        chain.get<delay>().allocate (arena, sampleRate);
+    }
+
+    /// Bytes the JUCE chorus and reverb allocate for themselves in prepare(),
+    /// which can't come from the arena. Worked out the way JUCE sizes them:
+    /// the reverb's comb and all-pass lines scale from their 44.1 kHz tunings,
+    /// and the chorus keeps 110 ms of delay plus a few block-sized buffers.
+    static size_t getUnpooledBytes (double sampleRate, int blockSize) noexcept
+    {
+        constexpr double reverbFloatsAt44k = 2 * (11044 + 1563) + 12 * 23;
+        auto reverbFloats = reverbFloatsAt44k * sampleRate / 44100.0;
+        auto chorusFloats = numChannels * (std::ceil (0.11 * sampleRate) + 1) + (numChannels + 1) * blockSize;
+
+        return (size_t) (reverbFloats + chorusFloats) * sizeof (float);
+    }
+
+    /// Message thread, with rendering stopped. This is where the stages allocate.
+    void prepare (double sampleRate)
+    {
+        chain.prepare ({ sampleRate, (uint32) blockSize, (uint32) numChannels });
+        chain.reset();
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            auto on = enabled[stage].load (std::memory_order_relaxed);
+            fades[stage].reset (sampleRate, fadeSeconds);
+            fades[stage].setCurrentAndTargetValue (on ? 1.0f : 0.0f);
+            running[stage] = on;
+            profilers[stage].prepare (sampleRate);
+        }
+    }
+
+    /// Any thread: switches a stage on or off, with a short crossfade.
+    void setEnabled (int stage, bool shouldBeEnabled) noexcept
+    {
+        enabled[stage].store (shouldBeEnabled, std::memory_order_relaxed);
+    }
+
+    bool isEnabled (int stage) const noexcept       { return enabled[stage].load (std::memory_order_relaxed); }
+
+    /// Rendering thread: true while any stage is on or still fading out.
+    bool isActive() const noexcept
+    {
+        for (int stage = 0; stage < numStages; ++stage)
+            if (running[stage] || isEnabled (stage))
+                return true;
+
+        return false;
+    }
+
+    const CallbackProfiler& getProfiler (int stage) const noexcept  { return profilers[stage]; }
+
+    /// Processes the first numChannels channels of numSamples (at most the
+    /// allocated block size) in place. Runs on whichever thread renders.
+    void process (AudioBuffer<float>& buffer, int numSamples) noexcept
+    {
+        if (buffer.getNumChannels() < numChannels || dry[0] == nullptr)
+            return;
+
+        jassert (numSamples <= blockSize);
+        dsp::AudioBlock<float> block (buffer.getArrayOfWritePointers(), (size_t) numChannels, (size_t) numSamples);
+        processStages (block, std::make_index_sequence<numStages>());
+    }
+
+private:
+    template <size_t... stages>
+    void processStages (dsp::AudioBlock<float>& block, std::index_sequence<stages...>) noexcept
+    {
+        (processStage<(int) stages> (block), ...);
+    }
+
+    template <int stage>
+    void processStage (dsp::AudioBlock<float>& block) noexcept
+    {
+        auto& fade = fades[stage];
+        auto on = enabled[stage].load (std::memory_order_relaxed);
+
+        if (on != (fade.getTargetValue() > 0.5f))
+        {
+            if (on && ! running[stage])
+            {
+                chain.get<stage>().reset();
+                running[stage] = true;
+            }
+
+            fade.setTargetValue (on ? 1.0f : 0.0f);
+        }
+
+        if (! running[stage])
+            return;
+
+        const CallbackProfiler::ScopedMeasurement measurement (profilers[stage], (int) block.getNumSamples());
+        const dsp::ProcessContextReplacing<float> context (block);
+
+        if (! fade.isSmoothing())
+        {
+            chain.get<stage>().process (context);
+            return;
+        }
+
+        auto numSamples = (int) block.getNumSamples();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            FloatVectorOperations::copy (dry[channel], block.getChannelPointer ((size_t) channel), numSamples);
+
+        chain.get<stage>().process (context);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto wet = fade.getNextValue();
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* samples = block.getChannelPointer ((size_t) channel);
+                samples[i] = dry[channel][i] + wet * (samples[i] - dry[channel][i]);
+            }
+        }
+
+        // Faded all the way out: from now on the stage isn't called at all
+        if (! fade.isSmoothing() && fade.getTargetValue() == 0.0f)
+            running[stage] = false;
+    }
+
+    dsp::ProcessorChain<dsp::Chorus<float>, FeedbackDelay, dsp::Reverb, dsp::Limiter<float>> chain;
+
+    std::atomic<bool> enabled[numStages] {};
+    bool running[numStages] {};
+    SmoothedValue<float> fades[numStages];
+    CallbackProfiler profilers[numStages];
+
+    int blockSize = 1;
+    float* dry[numChannels] {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MasterEffects)
+};
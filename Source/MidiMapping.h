@@ -0,0 +1,344 @@
+/*
+  ==============================================================================
+
+    MidiMapping.h
+    Created:    18 Oct 2026 1:02:14am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include "Modulation.h"
+#include "TripleBuffer.h"
+
+/// A MIDI controller a parameter can be bound to: a plain 7-bit CC, a 14-bit
+/// CC (an MSB on 0..31 with its LSB 32 higher) or an NRPN.
+struct MidiController
+{
+    enum class Type
+    {
+        none,
+        controller,
+        controller14Bit,
+        nrpn
+    };
+
+    Type type = Type::none;
+    int channel = 0;    // 1..16
+    int number = 0;     // CC 0..127, or NRPN 0..16383
+
+    bool operator== (const MidiController& other) const noexcept
+    {
+        return type == other.type && channel == other.channel && number == other.number;
+    }
+
+    /// Packs into a non-zero int (0 is Type::none), so it fits in a std::atomic.
+    int pack() const noexcept           { return ((int) type << 24) | (channel << 16) | number; }
+
+    static MidiController unpack (int packed) noexcept
+    {
+        return { (Type) (packed >> 24), (packed >> 16) & 0xff, packed & 0xffff };
+    }
+
+    String describe() const
+    {
+        switch (type)
+        {
+            case Type::controller:      return "CC " + String (number) + " ch " + String (channel);
+            case Type::controller14Bit: return "CC " + String (number) + "/" + String (number + 32) + " ch " + String (channel);
+            case Type::nrpn:            return "NRPN " + String (number) + " ch " + String (channel);
+            case Type::none:            break;
+        }
+
+        return {};
+    }
+};
+
+/// MidiMapping binds MIDI controllers to patch parameters: the morph
+/// position (both axes of a vector morph), the output level and the depth of
+/// any modulation route.
+///
+/// The bindings are edited on the message thread and published to the audio
+/// thread through a triple buffer, so neither side ever waits for the other
+/// and nothing is allocated after construction.
+///
+/// MIDI learn works the same way round: the message thread arms a parameter,
+/// the audio thread records the first controller it sees in an atomic, and
+/// the message thread picks that up in updateLearning() and publishes the new
+/// binding. A learned MSB whose LSB follows is learned as a 14-bit CC.
+class MidiMapping
+{
+public:
+    static constexpr int morphParameter = 0, levelParameter = 1, morphYParameter = 2, firstRouteParameter = 3;
+    static constexpr int numParameters = firstRouteParameter + numModDestinations * numModSources;
+    static constexpr int maxBindings = 32;
+
+    struct Binding
+    {
+        MidiController controller;
+        int parameter = 0;
+        float minimum = 0.0f, maximum = 1.0f;
+    };
+
+    static int getRouteParameter (ModSource source, ModDestination destination) noexcept
+    {
+        return firstRouteParameter + (int) destination * numModSources + (int) source;
+    }
+
+    /// For a route parameter.
+    static ModSource getSource (int parameter) noexcept            { return (ModSource) ((parameter - firstRouteParameter) % numModSources); }
+    static ModDestination getDestination (int parameter) noexcept  { return (ModDestination) ((parameter - firstRouteParameter) / numModSources); }
+
+    static String getParameterName (int parameter)
+    {
+        static const char* const sourceNames[] = { "LFO", "Amp env", "Mod env", "Velocity", "Mod wheel" };
+        static const char* const destinationNames[] = { "morph", "pitch", "level", "FM index", "sync", "cutoff", "morph Y", "noise" };
+
+        if (parameter == morphParameter)    return "Morph";
+        if (parameter == levelParameter)    return "Level";
+        if (parameter == morphYParameter)   return "Morph Y";
+
+        return String (sourceNames[(int) getSource (parameter)]) + " > " + destinationNames[(int) getDestination (parameter)];
+    }
+
+    /// The range a controller sweeps unless told otherwise. Route depths are in
+    /// the destination's units, so pitch, sync and cutoff get semitones.
+    static Range<float> getDefaultRange (int parameter) noexcept
+    {
+        if (parameter < firstRouteParameter)
+            return { 0.0f, 1.0f };
+
+        switch (getDestination (parameter))
+        {
+            case ModDestination::pitch:         return { 0.0f, 12.0f };
+            case ModDestination::fmIndex:       return { 0.0f, 10.0f };
+            case ModDestination::syncSemitones: return { 0.0f, 24.0f };
+            case ModDestination::cutoff:        return { 0.0f, 48.0f };
+            case ModDestination::morph:
+            case ModDestination::level:
+            case ModDestination::morphY:
+            case ModDestination::noise:         break;
+        }
+
+        return { 0.0f, 1.0f };
+    }
+
+    //==============================================================================
+    /// Message thread: binds a controller over the parameter's default range,
+    /// replacing whatever the parameter or the controller was bound to before.
+    void bind (int parameter, MidiController controller)
+    {
+        jassert (isPositiveAndBelow (parameter, numParameters));
+        unbindWhere ([&] (const Binding& b) { return b.parameter == parameter || b.controller == controller; });
+
+        if (bindings.size() < maxBindings)
+        {
+            auto range = getDefaultRange (parameter);
+            bindings.add ({ controller, parameter, range.getStart(), range.getEnd() });
+        }
+
+        publish();
+    }
+
+    /// Message thread.
+    void unbind (int parameter)
+    {
+        unbindWhere ([&] (const Binding& b) { return b.parameter == parameter; });
+        publish();
+    }
+
+    /// Message thread: the controller bound to a parameter, if any.
+    MidiController getController (int parameter) const
+    {
+        for (auto& b : bindings)
+            if (b.parameter == parameter)
+                return b.controller;
+
+        return {};
+    }
+
+    const Array<Binding>& getBindings() const noexcept     { return bindings; }
+
+    /// Message thread: the next controller that moves gets bound to `parameter`.
+    void startLearning (int parameter) noexcept
+    {
+        learnedController.store (0, std::memory_order_relaxed);
+        learningParameter.store (parameter, std::memory_order_release);
+    }
+
+    void stopLearning() noexcept                { learningParameter.store (-1, std::memory_order_release); }
+
+    /// Message thread: the parameter waiting for a controller, or -1.
+    int getLearningParameter() const noexcept   { return learningParameter.load (std::memory_order_acquire); }
+
+    /// Message thread, polled while learning: binds the learned controller and
+    /// returns true once one has arrived.
+    bool updateLearning()
+    {
+        auto parameter = getLearningParameter();
+
+        if (parameter < 0)
+            return false;
+
+        auto controller = MidiController::unpack (learnedController.load (std::memory_order_acquire));
+
+        if (controller.type == MidiController::Type::none)
+            return false;
+
+        stopLearning();
+        learnedController.store (0, std::memory_order_relaxed);
+        bind (parameter, controller);
+        return true;
+    }
+
+    //==============================================================================
+    /// Audio thread: decodes a controller message, calling apply (parameter,
+    /// value) for the binding it moves, if any.
+    template <typename Callback>
+    void handleController (int channel, int number, int value, Callback&& apply) noexcept
+    {
+        if (! isPositiveAndBelow (channel - 1, 16) || ! isPositiveAndBelow (number, 128))
+            return;
+
+        auto& state = channels[channel - 1];
+        auto& table = getTable();
+
+        auto send = [&] (MidiController::Type type, int controllerNumber, float normalised)
+        {
+            const MidiController controller { type, channel, controllerNumber };
+
+            for (int i = 0; i < table.numBindings; ++i)
+            {
+                auto& b = table.bindings[i];
+
+                if (b.controller == controller)
+                    apply (b.parameter, b.minimum + normalised * (b.maximum - b.minimum));
+            }
+        };
+
+        switch (number)
+        {
+            case nrpnMsb:   state.nrpn = (value << 7) | (state.nrpn >= 0 ? state.nrpn & 0x7f : 0); return;
+            case nrpnLsb:   state.nrpn = ((state.nrpn >= 0 ? state.nrpn >> 7 : 0) << 7) | value; return;
+            case rpnMsb:
+            case rpnLsb:    state.nrpn = -1; return;
+
+            case dataEntryMsb:
+            case dataEntryLsb:
+                if (state.nrpn >= 0)
+                {
+                    // The MSB clears the LSB, as for any 14-bit controller
+                    state.data = number == dataEntryMsb ? (value << 7) : ((state.data & ~0x7f) | value);
+                    learn ({ MidiController::Type::nrpn, channel, state.nrpn }, true);
+                    send (MidiController::Type::nrpn, state.nrpn, (float) state.data / 16383.0f);
+                }
+                return;
+
+            default:
+                break;
+        }
+
+        if (number < 32)
+        {
+            state.msb[number] = (uint8) value;
+            send (MidiController::Type::controller14Bit, number, (float) (value << 7) / 16383.0f);
+        }
+        else if (number < 64)
+        {
+            auto msbNumber = number - 32;
+            send (MidiController::Type::controller14Bit, msbNumber, (float) ((state.msb[msbNumber] << 7) | value) / 16383.0f);
+
+            // The LSB of a controller being learned makes it 14-bit
+            if (learnedController.load (std::memory_order_relaxed) == MidiController { MidiController::Type::controller, channel, msbNumber }.pack())
+                learn ({ MidiController::Type::controller14Bit, channel, msbNumber }, true);
+        }
+
+        learn ({ MidiController::Type::controller, channel, number }, false);
+        send (MidiController::Type::controller, number, (float) value / 127.0f);
+    }
+
+    /// Audio thread: whether any controller is bound to the parameter.
+    bool isBound (int parameter) noexcept
+    {
+        auto& table = getTable();
+
+        for (int i = 0; i < table.numBindings; ++i)
+            if (table.bindings[i].parameter == parameter)
+                return true;
+
+        return false;
+    }
+
+private:
+    enum
+    {
+        dataEntryMsb = 6,
+        dataEntryLsb = 38,
+        nrpnLsb = 98,
+        nrpnMsb = 99,
+        rpnLsb = 100,
+        rpnMsb = 101
+    };
+
+    struct Table
+    {
+        Binding bindings[maxBindings];
+        int numBindings = 0;
+    };
+
+    /// Per MIDI channel: the selected NRPN (-1 for none) and the last MSB of
+    /// every 14-bit controller, for combining with the LSB that follows.
+    struct ChannelState
+    {
+        int nrpn = -1, data = 0;
+        uint8 msb[32] {};
+    };
+
+    template <typename Predicate>
+    void unbindWhere (Predicate&& predicate)
+    {
+        for (int i = bindings.size(); --i >= 0;)
+            if (predicate (bindings.getReference (i)))
+                bindings.remove (i);
+    }
+
+    /// Message thread: hands a copy of the bindings to the audio thread.
+    void publish() noexcept
+    {
+        auto& table = tables.getBack();
+        table.numBindings = jmin (maxBindings, bindings.size());
+
+        for (int i = 0; i < table.numBindings; ++i)
+            table.bindings[i] = bindings.getReference (i);
+
+        tables.publish();
+    }
+
+    /// Audio thread: the newest published table.
+    const Table& getTable() noexcept
+    {
+        tables.update();
+        return tables.getFront();
+    }
+
+    /// Audio thread: an unconditional controller replaces a plain CC guess,
+    /// which is how NRPNs and 14-bit CCs win over the CCs they are made of.
+    void learn (MidiController controller, bool overridesPlainController) noexcept
+    {
+        if (learningParameter.load (std::memory_order_relaxed) < 0)
+            return;
+
+        auto current = MidiController::unpack (learnedController.load (std::memory_order_relaxed));
+
+        if (current.type == MidiController::Type::none
+             || (overridesPlainController && current.type == MidiController::Type::controller))
+            learnedController.store (controller.pack(), std::memory_order_release);
+    }
+
+    Array<Binding> bindings;
+    TripleBuffer<Table> tables;
+
+    ChannelState channels[16];
+    std::atomic<int> learningParameter { -1 }, learnedController { 0 };
+};
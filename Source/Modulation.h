@@ -0,0 +1,307 @@
+/*
+  ==============================================================================
+
+    Modulation.h
+    Created:    17 Oct 2026 7:52:18pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>
+
+/// Lfo is a free-running low-frequency oscillator meant to be evaluated at
+/// control rate: advance() jumps a whole control interval at once and returns
+/// the value at its end, which the voice then interpolates towards.
+struct Lfo
+{
+    enum class Shape
+    {
+        sine,
+        triangle,
+        saw,
+        square
+    };
+
+    void reset (double startPhase = 0.0) noexcept     { phase = startPhase; }
+
+    /// Moves numSamples forward and returns the new value, in -1..1.
+    float advance (Shape shape, double rateHz, int numSamples, double sampleRate) noexcept
+    {
+        phase += rateHz * numSamples / sampleRate;
+        phase -= std::floor (phase);
+        return getValue (shape, phase);
+    }
+
+    /// phase is in cycles, 0..1.
+    static float getValue (Shape shape, double phase) noexcept
+    {
+        switch (shape)
+        {
+            case Shape::triangle:   return (float) (1.0 - 4.0 * std::abs (phase - 0.5));
+            case Shape::saw:        return (float) (2.0 * phase - 1.0);
+            case Shape::square:     return phase < 0.5 ? 1.0f : -1.0f;
+            case Shape::sine:       break;
+        }
+
+        return (float) std::sin (MathConstants<double>::twoPi * phase);
+    }
+
+    double phase = 0.0;
+};
+
+/// Envelope is a linear ADSR that, like Lfo, advances a whole control interval
+/// per call instead of one sample, so its cost doesn't depend on the sample rate.
+struct Envelope
+{
+    struct Parameters
+    {
+        float attackSeconds = 0.005f, decaySeconds = 0.1f, sustainLevel = 1.0f, releaseSeconds = 0.05f;
+    };
+
+    /// Starts the attack from the current level, so retriggering never jumps.
+    void noteOn() noexcept      { stage = Stage::attack; }
+
+    /// Starts the release from the current level. Does nothing if already
+    /// releasing, since restarting would slow the release down each time.
+    void noteOff() noexcept
+    {
+        if (stage != Stage::idle && stage != Stage::release)
+        {
+            stage = Stage::release;
+            releaseFrom = value;
+        }
+    }
+
+    void reset() noexcept       { stage = Stage::idle; value = 0.0f; }
+
+    bool isActive() const noexcept  { return stage != Stage::idle; }
+    float getValue() const noexcept { return value; }
+
+    /// Moves numSamples forward and returns the new level, in 0..1.
+    float advance (const Parameters& parameters, int numSamples, double sampleRate) noexcept
+    {
+        auto seconds = (float) (numSamples / sampleRate);
+
+        // A long control interval can span several stages
+        for (;;)
+        {
+            switch (stage)
+            {
+                case Stage::attack:
+                    if (! moveTowards (1.0f, 1.0f / parameters.attackSeconds, seconds))
+                        return value;
+
+                    stage = Stage::decay;
+                    break;
+
+                case Stage::decay:
+                    if (! moveTowards (parameters.sustainLevel, (1.0f - parameters.sustainLevel) / parameters.decaySeconds, seconds))
+                        return value;
+
+                    stage = Stage::sustain;
+                    break;
+
+                case Stage::sustain:
+                    value = parameters.sustainLevel;
+                    return value;
+
+                case Stage::release:
+                    if (! moveTowards (0.0f, releaseFrom / parameters.releaseSeconds, seconds))
+                        return value;
+
+                    stage = Stage::idle;
+                    break;
+
+                case Stage::idle:
+                    value = 0.0f;
+                    return value;
+            }
+        }
+    }
+
+private:
+    enum class Stage
+    {
+        idle,
+        attack,
+        decay,
+        sustain,
+        release
+    };
+
+    /// Moves value towards target at `rate` per second, using up `seconds`.
+    /// Returns true if the target was reached (the remaining time is left in seconds).
+    bool moveTowards (float target, float rate, float& seconds) noexcept
+    {
+        auto distance = std::abs (target - value);
+
+        if (! std::isfinite (rate) || rate <= 0.0f || distance <= rate * seconds)
+        {
+            seconds -= std::isfinite (rate) && rate > 0.0f ? distance / rate : 0.0f;
+            value = target;
+            return true;
+        }
+
+        value += (target > value ? rate : -rate) * seconds;
+        seconds = 0.0f;
+        return false;
+    }
+
+    Stage stage = Stage::idle;
+    float value = 0.0f, releaseFrom = 0.0f;
+};
+
+/// Where modulation comes from and where it goes; see ModulationMatrix.
+enum class ModSource
+{
+    lfo,
+    ampEnvelope,
+    modEnvelope,
+    velocity,
+    modWheel
+};
+
+enum class ModDestination
+{
+    morph,      // added to the morph position, 0..1
+    pitch,      // in semitones
+    level,      // scales the level by (1 + amount)
+    fmIndex,        // in radians, added to FmParameters::index
+    syncSemitones,  // added to SyncParameters::semitones
+    cutoff,         // in semitones, shifts FilterParameters::cutoffHz
+    morphY,         // added to the vector morph's y position, 0..1
+    noise           // added to NoiseParameters::mix, 0..1
+};
+
+constexpr int numModSources = 5;
+constexpr int numModDestinations = 8;
+
+/// FM in the DX7 sense: a second morph oscillator on the same wavetables
+/// modulates the phase of the main one (the carrier).
+struct FmParameters
+{
+    enum class BandLimit
+    {
+        none,       // the carrier reads the mip for its own pitch
+        carsonsRule // ...or for its pitch plus (index + 1) modulator frequencies
+    };
+
+    float ratio = 1.0f;             // modulator frequency / carrier frequency
+    float index = 0.0f;             // peak phase deviation in radians; 0 with no route switches FM off
+    double modulatorMorph = 0.0;    // 0..1, like the carrier's morph position
+    BandLimit bandLimit = BandLimit::carsonsRule;
+};
+
+/// Hard sync: a hidden master oscillator at the note's pitch restarts the
+/// morph oscillator's cycle once per period, while the morph oscillator
+/// itself runs `semitones` higher.
+struct SyncParameters
+{
+    bool enabled = false;
+    float semitones = 12.0f;    // never below 0
+};
+
+/// Vector synthesis: the morph position is x and a second position y, and
+/// the point (x, y) blends four corner waves of the set (see VectorMorph).
+struct VectorParameters
+{
+    bool enabled = false;
+
+    /// Morph positions (0..1 across the set) of the waves at (0, 0), (1, 0),
+    /// (0, 1) and (1, 1), so the same corners suit a set of any size.
+    double corners[4] { 0.0, 1.0 / 3.0, 2.0 / 3.0, 1.0 };   // four different waves in any set of four or more
+};
+
+/// Noise as a morph target: each voice crossfades from its oscillator into
+/// its own noise (see NoiseSource) by `mix`, so a route into
+/// ModDestination::noise can take a sine to a breath and back.
+struct NoiseParameters
+{
+    enum class Colour
+    {
+        white,
+        pink,
+        brown
+    };
+
+    Colour colour = Colour::white;
+    float mix = 0.0f;       // 0 is all oscillator, 1 all noise
+    uint32 seed = 1;        // with the voice and how many notes it has played, seeds every note's noise
+};
+
+/// A resonant filter on every voice, after the oscillator; see VoiceFilterBank.
+struct FilterParameters
+{
+    enum class Response
+    {
+        lowpass,
+        bandpass,
+        highpass
+    };
+
+    bool enabled = false;
+    Response response = Response::lowpass;
+    float cutoffHz = 2000.0f;
+    float resonance = 0.0f;     // 0..1, up to just short of self-oscillation
+};
+
+/// How the morph moves between neighbouring waves: crossfading their samples,
+/// or through their harmonics (see SpectralMorph).
+enum class MorphMode
+{
+    crossfade,
+    spectral
+};
+
+/// How a voice turns the morph into samples: by reading the band-limited
+/// tables, additively from the set's partials (see SineBank), or with
+/// whichever kernel is cheapest for the note (see OscillatorKernels).
+enum class OscillatorMode
+{
+    wavetable,
+    additive,
+    automatic
+};
+
+/// ModulationParameters is the per-patch modulation setup shared by all voices:
+/// one LFO and two envelopes, plus a routing matrix from every ModSource to
+/// every ModDestination. Modulators are evaluated every controlInterval
+/// samples and linearly interpolated in between; an interval of 1 evaluates
+/// them at audio rate.
+struct ModulationParameters
+{
+    Lfo::Shape lfoShape = Lfo::Shape::sine;
+    double lfoRateHz = 0.5;
+
+    /// Always shapes the level; its release is the voice's tail.
+    Envelope::Parameters ampEnvelope;
+
+    Envelope::Parameters modEnvelope { 0.0f, 0.5f, 0.0f, 0.1f };
+
+    MorphMode morphMode = MorphMode::crossfade;
+    OscillatorMode oscillatorMode = OscillatorMode::automatic;
+    FmParameters fm;
+    SyncParameters sync;
+    VectorParameters vector;
+    NoiseParameters noise;
+    FilterParameters filter;
+
+    float pitchBendRange = 2.0f;    // semitones at full deflection of the wheel
+    double glideSeconds = 0.0;      // portamento time from the last note played; 0 for none
+
+    int controlInterval = 32;
+
+    void setRoute (ModSource source, ModDestination destination, float depth) noexcept
+    {
+        routes[(int) destination][(int) source] = depth;
+    }
+
+    float getRoute (ModSource source, ModDestination destination) const noexcept
+    {
+        return routes[(int) destination][(int) source];
+    }
+
+    /// Depth of every route; 0 means not routed.
+    float routes[numModDestinations][numModSources] {};
+};
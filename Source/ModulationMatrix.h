@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.h
+    Created:    17 Oct 2026 8:46:33pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "Modulation.h"
+#include "RealtimeArena.h"
+
+/// ModulationMatrix evaluates the routes of a ModulationParameters for all
+/// voices at once.
+///
+/// Source values and destination amounts are kept as structure-of-arrays:
+/// one contiguous, 64-byte aligned row per source or destination, indexed by
+/// voice. Once per control interval every voice writes its source values into
+/// its column, process() runs one vectorised multiply-accumulate across all
+/// voices per active route, and every voice reads its destination amounts
+/// back. Unrouted pairs are skipped, so the cost is linear in the number of
+/// routes and almost independent of the number of voices.
+class ModulationMatrix
+{
+public:
+    /// Takes the rows from `arena` (which may be a dry run). Rows are padded to
+    /// a whole number of SIMD registers so the vector loops never need a tail.
+    void prepare (RealtimeArena& arena, int maxVoicesToUse)
+    {
+        maxVoices = maxVoicesToUse;
+        rowLength = (int) RealtimeArena::alignUp ((size_t) jmax (1, maxVoices), RealtimeArena::cacheLineSize / sizeof (float));
+
+        for (auto& row : sources)
+            row = arena.allocate<float> ((size_t) rowLength);
+
+        for (auto& row : destinations)
+            row = arena.allocate<float> ((size_t) rowLength);
+    }
+
+    int getMaxVoices() const noexcept   { return maxVoices; }
+
+    void setSource (ModSource source, int voice, float value) noexcept
+    {
+        jassert (isPositiveAndBelow (voice, maxVoices));
+        sources[(int) source][voice] = value;
+    }
+
+    /// For sources that are the same for every voice, such as a MIDI controller.
+    void setSourceForAllVoices (ModSource source, float value) noexcept
+    {
+        FloatVectorOperations::fill (sources[(int) source], value, rowLength);
+    }
+
+    float getDestination (ModDestination destination, int voice) const noexcept
+    {
+        jassert (isPositiveAndBelow (voice, maxVoices));
+        return destinations[(int) destination][voice];
+    }
+
+    /// destination[v] = sum over sources of depth * source[v], for the first numVoices voices.
+    void process (const ModulationParameters& parameters, int numVoices) noexcept
+    {
+        auto n = (int) RealtimeArena::alignUp ((size_t) jlimit (0, maxVoices, numVoices), RealtimeArena::cacheLineSize / sizeof (float));
+
+        for (int d = 0; d < numModDestinations; ++d)
+        {
+            FloatVectorOperations::clear (destinations[d], n);
+
+            for (int s = 0; s < numModSources; ++s)
+                if (auto depth = parameters.routes[d][s]; depth != 0.0f)
+                    FloatVectorOperations::addWithMultiply (destinations[d], sources[s], depth, n);
+        }
+    }
+
+private:
+    int maxVoices = 0, rowLength = 0;
+    float* sources[numModSources] {};
+    float* destinations[numModDestinations] {};
+};
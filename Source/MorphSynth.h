@@ -0,0 +1,394 @@
+/*
+  ==============================================================================
+
+    MorphSynth.h
+    Created:    17 Oct 2026 8:58:40pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include "MidiMapping.h"
+#include "ModulationMatrix.h"
+#include "MorphingOscillator.h"
+#include "Presets.h"
+#include "TripleBuffer.h"
+#include "Tuning.h"
+#include "VoiceFilterBank.h"
+
+/// MorphSynth is a Synthesiser of MorphingWaveformVoices that runs their
+/// modulation as one control tick for all voices every controlInterval
+/// samples: each active voice writes its sources into a ModulationMatrix, the
+/// matrix sums every route across all voices at once, and each voice reads its
+/// targets back and ramps towards them while rendering up to the next tick.
+///
+/// With the filter on, the voices render mono one group of
+/// VoiceFilterBank::lanes at a time, the group is filtered together, and only
+/// then mixed into the output.
+///
+/// A note that starts between ticks stays silent until the next one, which
+/// delays it by less than a control interval.
+///
+/// Voices look their notes up in a TuningTable owned here. A new tuning is
+/// built on the message thread and copied in by the audio thread at its next
+/// block, under a try-lock, so retuning never blocks the audio thread;
+/// sounding notes slide to their new pitch over one control interval.
+///
+/// A whole new Patch is handed over through a TripleBuffer and taken at the
+/// start of the next rendered block, so switching sounds never waits on a lock
+/// or allocates, however often it happens.
+///
+/// MIDI controllers bound in midiMapping move the morph, the level or a route
+/// depth at the exact sample they arrive: the voices re-aim their ramps from
+/// there to the end of the current control interval, so the change is smoothed
+/// like any other modulation rather than stepped.
+class MorphSynth final : public Synthesiser
+{
+public:
+    MorphSynth()
+    {
+        // Render up to every MIDI event, so mapped controllers land on their own sample
+        setMinimumRenderingSubdivisionSize (1, false);
+    }
+
+    /// Takes the voices' scratch memory and the matrix from `arena` (which may be
+    /// a dry run). Message thread, with the audio callback stopped.
+    void prepare (RealtimeArena& arena, int maximumBlockSize, double sampleRate)
+    {
+        morphVoices.clearQuick();
+
+        // The table only depends on the tuning and the sample rate
+        if (! approximatelyEqual (sampleRate, tableSampleRate))
+        {
+            tableSampleRate = sampleRate;
+            const SpinLock::ScopedLockType sl (stagingLock);
+            staging.build (tuning, sampleRate);
+        }
+
+        activeTable = staging;
+        activeGeneration = stagingGeneration.load();
+
+        for (auto* voice : voices)
+        {
+            if (auto* morphVoice = dynamic_cast<MorphingWaveformVoice*> (voice))
+            {
+                morphVoice->prepareToPlay (arena, maximumBlockSize, sampleRate);
+                morphVoice->tuningTable = &activeTable;
+                morphVoice->spectralMorph = spectralMorph;
+                morphVoice->kernelUsage = &kernelUsage;
+                morphVoice->noiseSeed = (uint32) morphVoices.size();
+                morphVoices.add (morphVoice);
+            }
+        }
+
+        matrix.prepare (arena, morphVoices.size());
+        filterBank.prepare (arena, morphVoices.size(), maximumBlockSize, sampleRate);
+        renderBlockSize = jmax (1, maximumBlockSize);
+        controlCountdown = 0;
+    }
+
+    /// Message thread: switches to a new sound at the start of the next block.
+    /// This is the only way modulation settings reach the audio thread.
+    void setPatch (const Patch& patch) noexcept
+    {
+        patches.getBack() = patch;
+        patches.publish();
+    }
+
+    /// Message thread: retunes every voice, including the ones already playing.
+    void setTuning (const Tuning& newTuning)
+    {
+        tuning = newTuning;
+
+        if (tableSampleRate <= 0.0)
+            return;
+
+        {
+            const SpinLock::ScopedLockType sl (stagingLock);
+            staging.build (tuning, tableSampleRate);
+        }
+
+        ++stagingGeneration;
+    }
+
+    const Tuning& getTuning() const noexcept    { return tuning; }
+
+    /// Samples each oscillator kernel has rendered so far, over every voice. Any thread.
+    const KernelUsage& getKernelUsage() const noexcept     { return kernelUsage; }
+
+    /// Where voices in MorphMode::spectral get their frames; takes effect at
+    /// the next prepare(). Without one, spectral mode plays the plain set.
+    void setSpectralMorph (const SpectralMorph* newSpectralMorph) noexcept     { spectralMorph = newSpectralMorph; }
+
+    /// Controller bindings and MIDI learn; see MidiMapping for which thread calls what.
+    MidiMapping midiMapping;
+
+    void noteOn (int midiChannel, int midiNoteNumber, float velocity) override
+    {
+        Synthesiser::noteOn (midiChannel, midiNoteNumber, velocity);
+
+        // Portamento: whichever voice just took the note glides in from the last one played
+        auto notePitch = lastNotePitch;
+
+        for (auto* voice : morphVoices)
+        {
+            if (voice->isAwaitingGlide())
+            {
+                voice->glideFrom (lastNotePitch, lastNotePitch >= 0.0f ? modulation.glideSeconds : 0.0);
+
+                // The tuned pitch, and only if the tuning maps the note at all
+                if (voice->isVoiceActive())
+                    notePitch = voice->getTargetPitch();
+            }
+        }
+
+        lastNotePitch = notePitch;
+    }
+
+    void handleController (int midiChannel, int controllerNumber, int controllerValue) override
+    {
+        if (controllerNumber == 1)
+            modWheel = (float) controllerValue / 127.0f;
+
+        midiMapping.handleController (midiChannel, controllerNumber, controllerValue,
+                                      [this] (int parameter, float value) { setParameter (parameter, value); });
+
+        Synthesiser::handleController (midiChannel, controllerNumber, controllerValue);
+    }
+
+protected:
+    void renderVoices (AudioBuffer<float>& outputAudio, int startSample, int numSamples) override
+    {
+        adoptStagedTuning();
+        adoptPatch();
+
+        while (numSamples > 0)
+        {
+            if (controlCountdown == 0)
+                tickModulation();
+
+            auto numThisTime = jmin (numSamples, controlCountdown);
+
+            if (modulation.filter.enabled)
+                renderFiltered (outputAudio, startSample, numThisTime);
+            else
+                Synthesiser::renderVoices (outputAudio, startSample, numThisTime);
+
+            controlCountdown -= numThisTime;
+            startSample += numThisTime;
+            numSamples -= numThisTime;
+        }
+    }
+
+    using Synthesiser::renderVoices;
+
+private:
+    /// Audio thread: if the message thread is rebuilding the table right now,
+    /// this simply tries again next time.
+    void adoptStagedTuning() noexcept
+    {
+        auto generation = stagingGeneration.load (std::memory_order_acquire);
+
+        if (generation == activeGeneration)
+            return;
+
+        const SpinLock::ScopedTryLockType sl (stagingLock);
+
+        if (sl.isLocked())
+        {
+            activeTable = staging;
+            activeGeneration = generation;
+        }
+    }
+
+    /// Audio thread: a mapped controller moved. Its value stays on top of every
+    /// patch adopted afterwards, for as long as the controller stays bound, so
+    /// moving a slider or picking a preset doesn't snap it back.
+    void setParameter (int parameter, float value) noexcept
+    {
+        controllerValues[parameter] = value;
+        isControlled[parameter] = true;
+        applyParameter (parameter, value);
+        retargetModulation();
+    }
+
+    void applyParameter (int parameter, float value) noexcept
+    {
+        if (parameter == MidiMapping::morphParameter)
+        {
+            for (auto* voice : morphVoices)
+                voice->updateMorphFunctions (value);
+        }
+        else if (parameter == MidiMapping::levelParameter)
+        {
+            for (auto* voice : morphVoices)
+                voice->level = value;
+        }
+        else if (parameter == MidiMapping::morphYParameter)
+        {
+            for (auto* voice : morphVoices)
+                voice->morphPositionY = jlimit (0.0, 1.0, (double) value);
+        }
+        else
+        {
+            modulation.setRoute (MidiMapping::getSource (parameter), MidiMapping::getDestination (parameter), value);
+        }
+    }
+
+    /// Re-aims every active voice's ramps from the current sample to the end of
+    /// the control interval, without advancing the modulators. Between ticks
+    /// only; at a tick boundary the tick itself picks the change up.
+    void retargetModulation() noexcept
+    {
+        if (controlCountdown == 0)
+            return;
+
+        matrix.process (modulation, morphVoices.size());
+
+        for (int i = 0; i < morphVoices.size(); ++i)
+            if (morphVoices.getUnchecked (i)->isVoiceActive())
+                morphVoices.getUnchecked (i)->readModulationTargets (matrix, i, controlCountdown);
+
+        updateFilters();
+    }
+
+    /// Audio thread.
+    void adoptPatch() noexcept
+    {
+        if (! patches.update())
+            return;
+
+        const auto& patch = patches.getFront();
+        modulation = patch.modulation;
+
+        for (auto* voice : morphVoices)
+        {
+            voice->updateMorphFunctions (patch.morph);
+            voice->morphPositionY = patch.morphY;
+            voice->level = patch.level;
+        }
+
+        // The controllers' layer, over the patch
+        for (int parameter = 0; parameter < MidiMapping::numParameters; ++parameter)
+        {
+            if (! isControlled[parameter])
+                continue;
+
+            if (midiMapping.isBound (parameter))
+                applyParameter (parameter, controllerValues[parameter]);
+            else
+                isControlled[parameter] = false;
+        }
+
+        retargetModulation();
+    }
+
+    void tickModulation() noexcept
+    {
+        auto interval = jmax (1, modulation.controlInterval);
+
+        for (int i = 0; i < morphVoices.size(); ++i)
+            if (morphVoices.getUnchecked (i)->isVoiceActive())
+                morphVoices.getUnchecked (i)->writeModulationSources (matrix, i, modulation, interval);
+
+        matrix.setSourceForAllVoices (ModSource::modWheel, modWheel);
+        matrix.process (modulation, morphVoices.size());
+
+        for (int i = 0; i < morphVoices.size(); ++i)
+            if (morphVoices.getUnchecked (i)->isVoiceActive())
+                morphVoices.getUnchecked (i)->readModulationTargets (matrix, i, interval);
+
+        updateFilters();
+        controlCountdown = interval;
+    }
+
+    /// Sets every active voice's filter from the matrix; coefficients are only
+    /// recomputed where something changed.
+    void updateFilters() noexcept
+    {
+        if (! modulation.filter.enabled)
+            return;
+
+        const auto& filter = modulation.filter;
+
+        for (int i = 0; i < morphVoices.size(); ++i)
+            if (morphVoices.getUnchecked (i)->isVoiceActive())
+                filterBank.setVoice (i, filter.response,
+                                     filter.cutoffHz * FastMath::exp2 (matrix.getDestination (ModDestination::cutoff, i) / 12.0f),
+                                     filter.resonance);
+    }
+
+    /// A control interval may be longer than the prepared block, so this works
+    /// through it in pieces the voices' scratch buffers can hold.
+    void renderFiltered (AudioBuffer<float>& outputAudio, int startSample, int numSamples) noexcept
+    {
+        while (numSamples > 0)
+        {
+            auto numThisTime = jmin (numSamples, renderBlockSize);
+            renderFilteredChunk (outputAudio, startSample, numThisTime);
+            startSample += numThisTime;
+            numSamples -= numThisTime;
+        }
+    }
+
+    void renderFilteredChunk (AudioBuffer<float>& outputAudio, int startSample, int numSamples) noexcept
+    {
+        for (int group = 0; group < filterBank.getNumGroups(); ++group)
+        {
+            float* channels[VoiceFilterBank::lanes] {};
+            auto anyPlaying = false;
+
+            for (int lane = 0; lane < VoiceFilterBank::lanes; ++lane)
+            {
+                auto index = group * VoiceFilterBank::lanes + lane;
+
+                if (index >= morphVoices.size())
+                    break;
+
+                if (morphVoices.getUnchecked (index)->renderMono (numSamples))
+                {
+                    channels[lane] = morphVoices.getUnchecked (index)->renderBuffer;
+                    anyPlaying = true;
+                }
+                else
+                {
+                    // Starts the next note on this voice from a clean state
+                    filterBank.forgetVoice (index);
+                }
+            }
+
+            if (! anyPlaying)
+                continue;
+
+            filterBank.processGroup (group, channels, numSamples);
+
+            for (int lane = 0; lane < VoiceFilterBank::lanes; ++lane)
+                if (channels[lane] != nullptr)
+                    morphVoices.getUnchecked (group * VoiceFilterBank::lanes + lane)->mixInto (outputAudio, startSample, numSamples);
+        }
+    }
+
+    // The modulation setup shared by every voice: the adopted patch's, audio thread only
+    ModulationParameters modulation;
+
+    Tuning tuning;
+    double tableSampleRate = 0.0;
+    TuningTable staging, activeTable;
+    SpinLock stagingLock;
+    TripleBuffer<Patch> patches;
+    float controllerValues[MidiMapping::numParameters] {};
+    bool isControlled[MidiMapping::numParameters] {};
+    const SpectralMorph* spectralMorph = nullptr;
+    KernelUsage kernelUsage;
+    std::atomic<uint32> stagingGeneration { 0 };
+    uint32 activeGeneration = 0;
+
+    Array<MorphingWaveformVoice*> morphVoices;
+    ModulationMatrix matrix;
+    VoiceFilterBank filterBank;
+    int controlCountdown = 0, renderBlockSize = 1;
+    float modWheel = 0.0f, lastNotePitch = -1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MorphSynth)
+};
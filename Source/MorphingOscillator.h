@@ -3,13 +3,23 @@
 
     MorphingOscillator.h
     Created:    24 Oct 2025 3:58:25pm
-    Modified:   2 Jan 2026 12:17:00pm
+    Modified:   18 Oct 2026 5:07:33am
 
   ==============================================================================
 */
 
 #pragma once
 #include <cmath>
+#include "FastMath.h"
+#include "ModulationMatrix.h"
+#include "NoiseSource.h"
+#include "OscillatorKernels.h"
+#include "Tuning.h"
+#include "RealtimeArena.h"
+#include "SineBank.h"
+#include "SpectralMorph.h"
+#include "VectorMorph.h"
+#include "WavetablePublisher.h"
 
 struct MorphingWaveformSound final : public SynthesiserSound
 {
@@ -19,73 +29,750 @@ struct MorphingWaveformSound final : public SynthesiserSound
 
 /// MorphingWaveformVoice is a simple 'morphing oscillator'
 /// that outputs a linear combination of two user-chosen waveforms. 
-/// This combination is controlled by the 'wavePosition' variable,
-/// allowing the user to dynamically 'fade' between the waveforms.
-/// This implementation includes sine, square, and triangle waves.
+/// This combination is controlled by the 'morphPosition' variable,
+/// allowing the user to dynamically 'fade' between the waveforms
+/// (or across every frame of a multi-frame wavetable).
+/// The waveforms are read from the band-limited WavetableSet currently
+/// published by a WavetablePublisher (sine, square, triangle and sawtooth by default).
+/// When a new set is published the voice crossfades to it at its next block.
+/// In MorphMode::spectral it plays the frames a SpectralMorph resynthesised
+/// from that set instead, once they are ready.
+/// In OscillatorMode::additive it sums the set's partials with a SineBank
+/// instead of reading the tables, unless FM or sync needs the tables' phase.
+/// In OscillatorMode::automatic it picks a Kernel for every run, whichever is
+/// cheapest for the pitch and morph (see OscillatorKernels).
+/// With VectorParameters enabled, morphPosition and morphPositionY are a
+/// point between four corner waves instead (see VectorMorph).
+/// Each voice owns an LFO and two envelopes. MorphSynth routes them (with
+/// velocity and the mod wheel) through a ModulationMatrix to morph, pitch and
+/// level every few samples, and the kernel interpolates linearly in between.
+/// Optionally a second morph oscillator phase-modulates the first (see
+/// FmParameters), and a hidden master oscillator hard-syncs it (see SyncParameters).
+/// Last, the result can be crossfaded into the voice's own noise (see NoiseParameters).
 struct MorphingWaveformVoice final : public SynthesiserVoice
 {
+    explicit MorphingWaveformVoice (WavetablePublisher& publisherToUse)
+        : publisher (publisherToUse)
+    {
+        tables = publisher.getActive();
+        tables->incReferenceCount();
+    }
+
+    ~MorphingWaveformVoice() override
+    {
+        // Not the audio thread, so dropping the last reference may free here
+        tables->decReferenceCount();
+
+        if (previousTables != nullptr)
+            previousTables->decReferenceCount();
+    }
+
     void startNote (int midiNoteNumber, float velocity,
-                    SynthesiserSound*, int /*currentPitchWheelPosition*/) override
+                    SynthesiserSound*, int currentPitchWheelPosition) override
     {
-        double currentFrequency = MidiMessage::getMidiNoteInHertz (midiNoteNumber);
-        double cyclesPerSample = currentFrequency / getSampleRate();
-        phaseIncrement = cyclesPerSample * juce::MathConstants<double>::twoPi;
+        // One lookup with a tuning table; 12-TET without one
+        currentNote = midiNoteNumber;
+        notePitch = glideTarget = tuningTable != nullptr ? tuningTable->pitches[midiNoteNumber] : (float) midiNoteNumber;
+        phaseIncrement = tuningTable != nullptr ? tuningTable->increments[midiNoteNumber]
+                                                : FastMath::pitchToIncrement (notePitch, getSampleRate());
+        glideRate = 0.0f;
+        pitchWheel = currentPitchWheelPosition;
+        awaitingGlide = true;
+        releasedByRetune = false;
+
+        // A note the keyboard mapping leaves out doesn't sound
+        if (approximatelyEqual (phaseIncrement, 0.0))
+        {
+            clearCurrentNote();
+            return;
+        }
+
+        lfo.reset();
+        modulatorPhase = 0.0;
+        syncMasterPhase = 0.0;
+        pendingSyncBlep = 0.0f;
+        ampEnvelope.noteOn();
+        modEnvelope.noteOn();
+        noteVelocity = velocity;
+        kernelChosen = false;
+
+        // Every note gets its own noise, the same from one render to the next
+        noiseSource.seed (noise.seed + 0x632be5abu * noiseSeed + 0x85157af5u * numNotesStarted++);
+
+        // Silent until the synth's next control tick, which starts the modulators
+        control = {};
+        control.morph = morphPosition;
+        control.morphY = morphPositionY;
+        control.increment = phaseIncrement * FastMath::exp2 (getBendSemitones() / 12.0f);
+        controlCountdown = 0;
+    }
+
+    /// Called by the synth right after startNote(): portamento from fromPitch
+    /// (a MIDI note number) to the new note, taking `seconds` whatever the interval.
+    void glideFrom (float fromPitch, double seconds) noexcept
+    {
+        awaitingGlide = false;
+
+        if (seconds <= 0.0 || approximatelyEqual (fromPitch, glideTarget))
+            return;
+
+        notePitch = fromPitch;
+        glideRate = (float) (std::abs (glideTarget - fromPitch) / seconds);
+        control.increment = FastMath::pitchToIncrement (notePitch + getBendSemitones(), getSampleRate());
+    }
+
+    bool isAwaitingGlide() const noexcept   { return awaitingGlide; }
+
+    /// The pitch the note sounds at once any glide is over, as a (fractional)
+    /// MIDI note number in the current tuning.
+    float getTargetPitch() const noexcept   { return glideTarget; }
+
+    float getBendSemitones() const noexcept
+    {
+        return (float) (pitchWheel - 8192) / 8192.0f * pitchBendRange;
+    }
+
+    /// Takes this voice's scratch memory from the engine arena.
+    /// Called twice per preparation: once to measure, once for real.
+    void prepareToPlay (RealtimeArena& arena, int maximumBlockSize, double sampleRate)
+    {
+        renderBufferSize = jmax (1, maximumBlockSize);
+        renderBuffer = arena.allocate<float> ((size_t) renderBufferSize);
+        crossfadeBuffer = arena.allocate<float> ((size_t) renderBufferSize);
+        phaseBuffer = arena.allocate<float> ((size_t) renderBufferSize);
+        modulatorBuffer = arena.allocate<float> ((size_t) renderBufferSize);
+        syncEvents = arena.allocate<SyncEvent> ((size_t) renderBufferSize);
+        noiseBuffer = arena.allocate<float> ((size_t) renderBufferSize);
+        numNotesStarted = 0;
+        crossfadeLength = jmax (1, roundToInt (sampleRate * crossfadeSeconds));
     }
 
     void renderNextBlock (AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override
     {
-        if (! approximatelyEqual (phaseIncrement, 0.0))
+        // Render mono into the scratch buffer, then mix it into every channel
+        while (numSamples > 0)
         {
-            while (--numSamples >= 0)
+            auto numThisTime = jmin (numSamples, renderBufferSize);
+
+            if (! renderMono (numThisTime))
+                break;
+
+            mixInto (outputBuffer, startSample, numThisTime);
+            startSample += numThisTime;
+            numSamples -= numThisTime;
+        }
+    }
+
+    /// Renders numSamples (at most the prepared block size) into renderBuffer.
+    /// Returns false, having rendered nothing, if the voice isn't playing.
+    bool renderMono (int numSamples) noexcept
+    {
+        adoptPublishedTables();
+
+        if (approximatelyEqual (phaseIncrement, 0.0) || renderBuffer == nullptr)
+            return false;
+
+        jassert (numSamples <= renderBufferSize);
+        renderModulated (numSamples);
+
+        // The release has finished and its last ramp has played out: free the voice
+        if (! ampEnvelope.isActive() && controlCountdown == 0)
+        {
+            phaseIncrement = 0.0;
+            clearCurrentNote();
+        }
+
+        return true;
+    }
+
+    /// Adds the first numSamples of renderBuffer to every channel.
+    void mixInto (AudioBuffer<float>& outputBuffer, int startSample, int numSamples) const noexcept
+    {
+        for (auto channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+            outputBuffer.addFrom (channel, startSample, renderBuffer, numSamples);
+    }
+
+    /// Morph position, phase increment, level, FM index, sync ratio and noise
+    /// mix at the start of a run of samples, plus how much each changes per sample.
+    struct ControlValues
+    {
+        double morph = 0.0, morphStep = 0.0, increment = 0.0, incrementStep = 0.0;
+        double morphY = 0.0, morphYStep = 0.0;
+        double syncRatio = 1.0, syncRatioStep = 0.0;
+        float level = 0.0f, levelStep = 0.0f, fmIndex = 0.0f, fmIndexStep = 0.0f;
+        float noiseMix = 0.0f, noiseMixStep = 0.0f;
+    };
+
+    /// A master reset that happened between sample and sample + 1.
+    struct SyncEvent
+    {
+        int sample;
+        float fraction;     // of that step left after the reset
+        float phaseBefore;  // slave phase (cycles) just before the reset
+    };
+
+    /// Fills numSamples of renderBuffer, ramping linearly towards the targets
+    /// set by the last readModulationTargets() and holding them once reached.
+    void renderModulated (int numSamples) noexcept
+    {
+        for (int offset = 0; offset < numSamples;)
+        {
+            if (controlCountdown == 0)
+                holdControl (numSamples - offset);
+
+            auto numThisTime = jmin (numSamples - offset, controlCountdown);
+            auto* dest = renderBuffer + offset;
+
+            auto highestIncrement = jmax (control.increment, control.increment + control.incrementStep * numThisTime);
+            auto phaseModulated = control.fmIndex > 0.0f || control.fmIndexStep != 0.0f;
+            auto startPhase = phaseIndex.phase;
+            int numSyncEvents = 0;
+
+            selectKernel (numThisTime, highestIncrement, phaseModulated);
+
+            if (sync.enabled)
             {
-                // Calculate wave values and interpolate
-                double wave_a_value = getWaveSample(wave_a);
-                double wave_b_value = getWaveSample(wave_b);
-                double interpolatedValue = (wave_a_value * (1.0 - wavePosition)) + (wave_b_value * wavePosition);
-                float levelAdjustedSample = static_cast<float>(interpolatedValue * level);
-                
-                auto outputLen = outputBuffer.getNumChannels();
-                for (auto channel = 0; channel < outputLen; ++channel)
-                    outputBuffer.addSample(channel, startSample, levelAdjustedSample);
-                phaseIndex.advance(phaseIncrement);
-                
-                startSample++;
+                numSyncEvents = fillSyncedPhaseRamp (numThisTime);
+                highestIncrement *= jmax (control.syncRatio, control.syncRatio + control.syncRatioStep * numThisTime);
             }
+            else if ((kernel == Kernel::additive || kernel == Kernel::sine) && previousTables == nullptr)
+            {
+                // Nothing reads the phase buffer, so only the phase at the end is needed
+                auto end = phaseIndex.phase + numThisTime * (control.increment + control.incrementStep * (numThisTime - 1) * 0.5);
+                phaseIndex.phase = end - MathConstants<double>::twoPi * std::floor (end / MathConstants<double>::twoPi);
+            }
+            else
+            {
+                phaseIndex.phase = fillPhaseRamp (phaseBuffer, numThisTime, phaseIndex.phase, control.increment, control.incrementStep);
+            }
+
+            if (phaseModulated)
+                highestIncrement = addPhaseModulation (numThisTime, highestIncrement);
+
+            switch (kernel)
+            {
+                case Kernel::wavetable:
+                    readMorph (*tables, dest, numThisTime, highestIncrement);
+                    break;
+
+                case Kernel::additive:
+                    SineBank::render (*tables, dest, numThisTime, startPhase, control.increment, control.incrementStep,
+                                      highestIncrement, control.morph, control.morphStep);
+                    break;
+
+                case Kernel::analytic:
+                    OscillatorKernels::renderEdges (kernelShape, dest, phaseBuffer, numThisTime, control.increment, control.incrementStep);
+                    break;
+
+                case Kernel::sine:
+                    OscillatorKernels::renderSine (kernelShape, dest, numThisTime, startPhase, control.increment, control.incrementStep);
+                    break;
+            }
+
+            if (sync.enabled)
+                applySyncBleps (*tables, dest, numThisTime, highestIncrement, numSyncEvents);
+
+            if (previousTables != nullptr)
+            {
+                readMorph (*previousTables, crossfadeBuffer, numThisTime, highestIncrement);
+
+                // Fade from the old set to the new one over crossfadeLength samples
+                auto numFading = jmin (numThisTime, crossfadeRemaining);
+                for (int i = 0; i < numFading; ++i)
+                {
+                    auto oldGain = static_cast<float>(crossfadeRemaining - i) / static_cast<float>(crossfadeLength);
+                    dest[i] += oldGain * (crossfadeBuffer[i] - dest[i]);
+                }
+
+                crossfadeRemaining -= numFading;
+
+                if (crossfadeRemaining == 0)
+                    releasePreviousTables();
+            }
+
+            if (control.noiseMix > 0.0f || control.noiseMixStep != 0.0f)
+            {
+                noiseSource.render (noise.colour, noiseBuffer, numThisTime);
+
+                for (int i = 0; i < numThisTime; ++i)
+                    dest[i] += (control.noiseMix + control.noiseMixStep * (float) i) * (noiseBuffer[i] - dest[i]);
+            }
+
+            for (int i = 0; i < numThisTime; ++i)
+                dest[i] *= control.level + control.levelStep * (float) i;
+
+            control.morph += control.morphStep * numThisTime;
+            control.morphY += control.morphYStep * numThisTime;
+            control.increment += control.incrementStep * numThisTime;
+            control.level += control.levelStep * (float) numThisTime;
+            control.fmIndex += control.fmIndexStep * (float) numThisTime;
+            control.syncRatio += control.syncRatioStep * numThisTime;
+            control.noiseMix += control.noiseMixStep * (float) numThisTime;
+            controlCountdown -= numThisTime;
+            offset += numThisTime;
         }
     }
 
-    double getWaveSample(int waveform) {
-        return waveform == 0 ? sineValue(phaseIndex.phase) :
-               waveform == 1 ? squareValue(phaseIndex.phase) :
-               triangleValue(phaseIndex.phase);
+    /// Reads the tables at the phases in phaseBuffer: the morph between two
+    /// waves, or the vector morph between four.
+    void readMorph (const WavetableSet& set, float* dest, int numSamples, double highestIncrement) const noexcept
+    {
+        if (vector.enabled)
+            VectorMorph::render (set, vector, dest, phaseBuffer, numSamples, highestIncrement,
+                                 control.morph, control.morphStep, control.morphY, control.morphYStep);
+        else
+            readTables (set, dest, phaseBuffer, numSamples, highestIncrement, control.morph, control.morphStep);
     }
 
-    void updateMorphFunctions(double position) {
-        // Updates wavePosition, which determines our waveforms and their respective scalars
-        double positionFloor = std::floor(position);
-        wave_a = static_cast<int>(positionFloor);
-        wave_b = std::clamp(wave_a + 1, 0, 2);
-        wavePosition = position - positionFloor;
+    /// Picks the kernel for the next run. FM and sync bend the phase that the
+    /// tables read, a sparse set has no partials, and the other kernels only
+    /// know two waves at a time, so all of those stay on the tables.
+    void selectKernel (int numSamples, double highestIncrement, bool phaseModulated) noexcept
+    {
+        auto previous = kernel;
+
+        if (sync.enabled || phaseModulated || vector.enabled || tables->getPartials (0) == nullptr)
+            kernel = Kernel::wavetable;
+        else if (oscillatorMode == OscillatorMode::automatic)
+            kernel = OscillatorKernels::choose (*tables, kernel, control.morph, control.morphStep, highestIncrement, kernelShape);
+        else
+            kernel = oscillatorMode == OscillatorMode::additive ? Kernel::additive : Kernel::wavetable;
+
+        if (kernelUsage != nullptr)
+        {
+            kernelUsage->add (kernel, numSamples);
+
+            if (kernelChosen && kernel != previous)
+                kernelUsage->addSwitch();
+        }
+
+        kernelChosen = true;
     }
 
-    bool canPlaySound (SynthesiserSound* sound) override { return dynamic_cast<MorphingWaveformSound*> (sound) != nullptr; }
-    void stopNote (float /*velocity*/, bool /*allowTailOff*/) override { phaseIncrement = 0.0; }
-    void pitchWheelMoved (int /*newValue*/) override                              {}
-    void controllerMoved (int /*controllerNumber*/, int /*newValue*/) override    {}
-    
-    double sineValue(double currentAngle) {
-        return std::sin(currentAngle);
+    /// Control tick, first half: moves this voice's modulators one control
+    /// interval forward and writes their values into its column of the matrix.
+    void writeModulationSources (ModulationMatrix& matrix, int column,
+                                 const ModulationParameters& parameters, int interval) noexcept
+    {
+        auto sampleRate = getSampleRate();
+        matrix.setSource (ModSource::lfo, column, lfo.advance (parameters.lfoShape, parameters.lfoRateHz, interval, sampleRate));
+        matrix.setSource (ModSource::ampEnvelope, column, ampEnvelope.advance (parameters.ampEnvelope, interval, sampleRate));
+        matrix.setSource (ModSource::modEnvelope, column, modEnvelope.advance (parameters.modEnvelope, interval, sampleRate));
+        matrix.setSource (ModSource::velocity, column, noteVelocity);
+        morphMode = parameters.morphMode;
+        vector = parameters.vector;
+        oscillatorMode = parameters.oscillatorMode;
+        fm = parameters.fm;
+        sync = parameters.sync;
+        noise = parameters.noise;
+        pitchBendRange = parameters.pitchBendRange;
+
+        // Retuned while playing: move to the new pitch, over the next control interval or the rest of the glide
+        if (tuningTable != nullptr && ! releasedByRetune && tuningTable->pitches[currentNote] != glideTarget)
+        {
+            // A tuning that leaves the note out releases it where it is, rather than
+            // gliding it to pitch 0. Only once: the release must run its course.
+            if (approximatelyEqual (tuningTable->increments[currentNote], 0.0))
+            {
+                releasedByRetune = true;
+                stopNote (0.0f, true);
+            }
+            else
+            {
+                if (approximatelyEqual (notePitch, glideTarget))
+                    notePitch = tuningTable->pitches[currentNote];
+
+                glideTarget = tuningTable->pitches[currentNote];
+            }
+        }
+
+        auto glideStep = glideRate * (float) (interval / sampleRate);
+        notePitch = notePitch < glideTarget ? jmin (glideTarget, notePitch + glideStep)
+                                            : jmax (glideTarget, notePitch - glideStep);
     }
-    double squareValue(double currentAngle) {
-        return 1.0 - 2.0 * static_cast<double>(std::sin(currentAngle) < 0.0);
+
+    /// Control tick, second half: reads the summed routes back and sets up
+    /// ramps that reach them after `interval` samples.
+    void readModulationTargets (const ModulationMatrix& matrix, int column, int interval) noexcept
+    {
+        auto semitones = matrix.getDestination (ModDestination::pitch, column);
+        auto targetMorph = jlimit (0.0, 1.0, morphPosition + matrix.getDestination (ModDestination::morph, column));
+        auto targetMorphY = jlimit (0.0, 1.0, morphPositionY + matrix.getDestination (ModDestination::morphY, column));
+        auto targetIncrement = FastMath::pitchToIncrement (notePitch + getBendSemitones() + semitones, getSampleRate());
+        auto targetLevel = (float) level * ampEnvelope.getValue()
+                             * jmax (0.0f, 1.0f + matrix.getDestination (ModDestination::level, column));
+        auto targetFmIndex = jmax (0.0f, fm.index + matrix.getDestination (ModDestination::fmIndex, column));
+        auto targetSyncRatio = (double) FastMath::exp2 (jmax (0.0f, sync.semitones + matrix.getDestination (ModDestination::syncSemitones, column)) / 12.0f);
+        auto targetNoiseMix = jlimit (0.0f, 1.0f, noise.mix + matrix.getDestination (ModDestination::noise, column));
+
+        control.morphStep = (targetMorph - control.morph) / interval;
+        control.morphYStep = (targetMorphY - control.morphY) / interval;
+        control.incrementStep = (targetIncrement - control.increment) / interval;
+        control.levelStep = (targetLevel - control.level) / (float) interval;
+        control.fmIndexStep = (targetFmIndex - control.fmIndex) / (float) interval;
+        control.syncRatioStep = (targetSyncRatio - control.syncRatio) / interval;
+        control.noiseMixStep = (targetNoiseMix - control.noiseMix) / (float) interval;
+        controlCountdown = interval;
     }
-    double triangleValue(double currentAngle) {
-        return (2.0 / MathConstants<double>::pi) * std::asin(std::sin(currentAngle));
+
+    /// Keeps the current values for numSamples, e.g. between a note starting and the next tick.
+    void holdControl (int numSamples) noexcept
+    {
+        control.morphStep = 0.0;
+        control.morphYStep = 0.0;
+        control.incrementStep = 0.0;
+        control.levelStep = 0.0f;
+        control.fmIndexStep = 0.0f;
+        control.syncRatioStep = 0.0;
+        control.noiseMixStep = 0.0f;
+        controlCountdown = numSamples;
     }
 
+    /// Writes the phase of numSamples samples into `cycles`, in cycles and
+    /// wrapped to 0..1, starting at `phase` radians with the increment ramping
+    /// by incrementStep per sample. Returns the phase after the last sample.
+    /// Each sample is computed from the start rather than the previous one, so
+    /// the loop vectorises.
+    static double fillPhaseRamp (float* cycles, int numSamples, double phase,
+                                 double increment, double incrementStep) noexcept
+    {
+        constexpr auto toCycles = 1.0 / MathConstants<double>::twoPi;
+        const auto start = phase * toCycles;
+        const auto perSample = increment * toCycles;
+        const auto halfStep = 0.5 * incrementStep * toCycles;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto position = start + i * perSample + (double) i * (i - 1) * halfStep;
+            cycles[i] = static_cast<float>(position - std::floor (position));
+        }
+
+        auto end = start + numSamples * perSample + (double) numSamples * (numSamples - 1) * halfStep;
+        return (end - std::floor (end)) * MathConstants<double>::twoPi;
+    }
+
+    /// Runs the modulator over numSamples and adds its output, scaled by the
+    /// ramped FM index, to the carrier phases in phaseBuffer. Returns the
+    /// increment the carrier should pick its mip for.
+    double addPhaseModulation (int numSamples, double highestIncrement) noexcept
+    {
+        // The modulator follows the note, even when the carrier is synced above it
+        const auto ratio = (double) fm.ratio;
+        const auto highestModulatorIncrement = jmax (control.increment, control.increment + control.incrementStep * numSamples) * ratio;
+
+        modulatorPhase = fillPhaseRamp (modulatorBuffer, numSamples, modulatorPhase,
+                                        control.increment * ratio, control.incrementStep * ratio);
+
+        // In place: each sample's phase is read before its output overwrites it
+        readTables (*tables, modulatorBuffer, modulatorBuffer, numSamples, highestModulatorIncrement, fm.modulatorMorph, 0.0);
+
+        constexpr auto toCycles = 1.0f / MathConstants<float>::twoPi;
+        const auto depth = control.fmIndex * toCycles;
+        const auto depthStep = control.fmIndexStep * toCycles;
+
+        for (int i = 0; i < numSamples; ++i)
+            phaseBuffer[i] += (depth + depthStep * (float) i) * modulatorBuffer[i];
+
+        if (fm.bandLimit == FmParameters::BandLimit::none)
+            return highestIncrement;
+
+        // Carson's rule: nearly all the energy lies within (index + 1) modulator frequencies of the carrier
+        auto peakIndex = (double) jmax (control.fmIndex, control.fmIndex + control.fmIndexStep * (float) numSamples);
+        return highestIncrement + (peakIndex + 1.0) * highestModulatorIncrement;
+    }
+
+    /// Like fillPhaseRamp into phaseBuffer, but a hidden master oscillator at
+    /// the note's pitch restarts the phase at the start of each of its cycles,
+    /// while the phase itself runs syncRatio times faster. Every restart is
+    /// recorded in syncEvents for applySyncBleps(); returns how many there were.
+    /// Scalar, as each restart depends on the one before.
+    int fillSyncedPhaseRamp (int numSamples) noexcept
+    {
+        constexpr auto toCycles = 1.0 / MathConstants<double>::twoPi;
+        auto slave = phaseIndex.phase * toCycles;
+        auto master = syncMasterPhase;
+        auto increment = control.increment * toCycles;
+        const auto incrementStep = control.incrementStep * toCycles;
+        auto ratio = control.syncRatio;
+        int numEvents = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            phaseBuffer[i] = static_cast<float>(slave);
+            auto slaveIncrement = increment * ratio;
+            master += increment;
+
+            if (master >= 1.0)
+            {
+                master -= 1.0;
+
+                auto& event = syncEvents[numEvents++];
+                auto after = jmin (1.0, master / increment);
+                auto before = slave + (1.0 - after) * slaveIncrement;
+                event.sample = i;
+                event.fraction = static_cast<float>(after);
+                event.phaseBefore = static_cast<float>(before - std::floor (before));
+
+                slave = after * slaveIncrement;
+            }
+            else
+            {
+                slave += slaveIncrement;
+            }
+
+            slave -= std::floor (slave);
+            increment += incrementStep;
+            ratio += control.syncRatioStep;
+        }
+
+        phaseIndex.phase = slave * MathConstants<double>::twoPi;
+        syncMasterPhase = master;
+        return numEvents;
+    }
+
+    /// Smooths the jump at every sync restart with a two-sample polynomial BLEP:
+    /// the residual between a band-limited and a naive step, scaled by the size
+    /// of the jump in the morphed waveform, is added on either side of it. The
+    /// jump is read from the tables at the current morph position, so this works
+    /// for any blend of waves. A residual that falls after the last sample is
+    /// added to the first sample of the next call.
+    void applySyncBleps (const WavetableSet& set, float* dest, int numSamples,
+                         double highestIncrement, int numEvents) noexcept
+    {
+        dest[0] += pendingSyncBlep;
+        pendingSyncBlep = 0.0f;
+
+        const MorphReader reader (set, highestIncrement);
+        const VectorMorph::Reader vectorReader (set, vector, highestIncrement);
+
+        if (reader.isSilent())
+            return;
+
+        for (int e = 0; e < numEvents; ++e)
+        {
+            const auto& event = syncEvents[e];
+            auto morph = control.morph + control.morphStep * event.sample;
+            float jump;
+
+            if (vector.enabled)
+            {
+                auto weights = VectorMorph::getWeights (morph, control.morphY + control.morphYStep * event.sample);
+                jump = vectorReader.read (weights, 0.0f) - vectorReader.read (weights, event.phaseBefore);
+            }
+            else
+            {
+                auto scaledPosition = morph * reader.lastWave;
+                jump = reader.read (scaledPosition, 0.0f) - reader.read (scaledPosition, event.phaseBefore);
+            }
+
+            auto after = 1.0f - event.fraction;
+
+            dest[event.sample] += jump * 0.5f * event.fraction * event.fraction;
+
+            if (event.sample + 1 < numSamples)
+                dest[event.sample + 1] -= jump * 0.5f * after * after;
+            else
+                pendingSyncBlep = -jump * 0.5f * after * after;
+        }
+    }
+
+    /// Reads the morph between the waves of the mip a set uses for a given
+    /// increment, with linear interpolation.
+    struct MorphReader
+    {
+        MorphReader (const WavetableSet& set, double highestIncrement) noexcept
+            : lastWave (set.getNumWaves() - 1),
+              tableMask (set.getTableSize() - 1),
+              tableScale (static_cast<float>(set.getTableSize()))
+        {
+            auto mip = set.findResidentMip (set.getMipForIncrement (highestIncrement / MathConstants<double>::twoPi));
+
+            // A sparse set whose levels haven't been decoded yet is read as silence.
+            // One load only: the decoder may detach the level at any moment, so
+            // the stride comes from the table size rather than a second pointer.
+            if (mip >= 0)
+                waves = set.getTable (0, mip);
+        }
+
+        bool isSilent() const noexcept  { return waves == nullptr; }
+
+        /// scaledPosition is the morph position times lastWave; cycles may be in any range.
+        float read (double scaledPosition, float cycles) const noexcept
+        {
+            // Pick the pair of waves around the morph position
+            const auto wave_a = jmin (static_cast<int>(scaledPosition), lastWave);
+            const auto wave_b = jmin (wave_a + 1, lastWave);
+            const float* table_a = waves + waveStride * wave_a;
+            const float* table_b = waves + waveStride * wave_b;
+            const auto position = static_cast<float>(scaledPosition - wave_a);
+
+            // Read both tables with linear interpolation, then morph between them
+            auto tablePosition = cycles * tableScale;
+            auto whole = std::floor (tablePosition);
+            auto index = static_cast<int>(whole) & tableMask;
+            auto frac = tablePosition - whole;
+            float wave_a_value = table_a[index] + frac * (table_a[index + 1] - table_a[index]);
+            float wave_b_value = table_b[index] + frac * (table_b[index + 1] - table_b[index]);
+            return wave_a_value + position * (wave_b_value - wave_a_value);
+        }
+
+        const int lastWave, tableMask;
+        const float tableScale;
+        const float* waves = nullptr;
+        const ptrdiff_t waveStride = (ptrdiff_t) WavetableSet::getStrideFor (tableMask + 1);
+    };
+
+    /// Reads numSamples of the morph from `set` into dest at the phases (in
+    /// cycles, any range) in `cycles`, with the morph position ramping from
+    /// morph by morphStep per sample. highestIncrement (radians per sample)
+    /// picks the mip.
+    static void readTables (const WavetableSet& set, float* dest, const float* cycles, int numSamples,
+                            double highestIncrement, double morph, double morphStep) noexcept
+    {
+        const MorphReader reader (set, highestIncrement);
+
+        if (reader.isSilent())
+        {
+            // The phase keeps running regardless
+            FloatVectorOperations::clear (dest, numSamples);
+            return;
+        }
+
+        auto scaledPosition = morph * reader.lastWave;
+        const auto scaledStep = morphStep * reader.lastWave;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            dest[i] = reader.read (scaledPosition, cycles[i]);
+            scaledPosition += scaledStep;
+        }
+    }
+
+    /// Audio thread: switches to the published set if it changed since the
+    /// last block. Only reference counts are touched, nothing is freed here.
+    /// A set published during a crossfade waits for it to finish, so the fade
+    /// never restarts from a set the voice has only half faded out.
+    void adoptPublishedTables() noexcept
+    {
+        // A voice cut off part way through a fade has nothing left to fade
+        if (approximatelyEqual (phaseIncrement, 0.0))
+            releasePreviousTables();
+
+        if (previousTables != nullptr)
+            return;
+
+        auto* published = publisher.getActive();
+
+        // Spectral frames replace the set once they exist, with the usual crossfade.
+        // A vector morph takes its corners from the set itself.
+        if (morphMode == MorphMode::spectral && ! vector.enabled && spectralMorph != nullptr)
+            if (auto* spectralFrames = spectralMorph->getFramesFor (*published))
+                published = spectralFrames;
+
+        if (published == tables)
+            return;
+
+        published->incReferenceCount();
+
+        if (approximatelyEqual (phaseIncrement, 0.0))
+        {
+            tables->decReferenceCountWithoutDeleting();
+        }
+        else
+        {
+            previousTables = tables;
+            crossfadeRemaining = crossfadeLength;
+        }
+
+        tables = published;
+    }
+
+    void releasePreviousTables() noexcept
+    {
+        if (previousTables != nullptr)
+        {
+            // The store always holds a reference as well, so this never reaches zero
+            [[maybe_unused]] auto wasLast = previousTables->decReferenceCountWithoutDeleting();
+            jassert (! wasLast);
+            previousTables = nullptr;
+        }
+    }
+
+    void updateMorphFunctions(double position) {
+        // Updates morphPosition, 0 being the first wave of the set and 1 the last.
+        // The pair of waves to blend and their scalars are derived per set while rendering
+        morphPosition = std::clamp(position, 0.0, 1.0);
+    }
+
+    bool canPlaySound (SynthesiserSound* sound) override { return dynamic_cast<MorphingWaveformSound*> (sound) != nullptr; }
+    void stopNote (float /*velocity*/, bool allowTailOff) override
+    {
+        if (allowTailOff && ampEnvelope.isActive())
+        {
+            // renderNextBlock frees the voice once the release has finished
+            ampEnvelope.noteOff();
+            modEnvelope.noteOff();
+            return;
+        }
+
+        phaseIncrement = 0.0;
+        ampEnvelope.reset();
+        modEnvelope.reset();
+        clearCurrentNote();
+    }
+
+    /// Takes effect at the next control tick, like any other modulation.
+    void pitchWheelMoved (int newValue) override                                  { pitchWheel = newValue; }
+    void controllerMoved (int /*controllerNumber*/, int /*newValue*/) override    {}
+
     using SynthesiserVoice::renderNextBlock;
 
     juce::dsp::Phase<double> phaseIndex { 0.0 };
-    double phaseIncrement = 0.0, level = 1.0, wavePosition = 0.0;
-    int wave_a = 0, wave_b = 0;
+    double phaseIncrement = 0.0, level = 1.0, morphPosition = 0.0, morphPositionY = 0.0;
+
+    float notePitch = 0.0f, glideTarget = 0.0f, glideRate = 0.0f, pitchBendRange = 2.0f;
+    int currentNote = 0, pitchWheel = 8192;
+    const TuningTable* tuningTable = nullptr;
+    const SpectralMorph* spectralMorph = nullptr;
+    MorphMode morphMode = MorphMode::crossfade;
+    VectorParameters vector;
+    OscillatorMode oscillatorMode = OscillatorMode::automatic;
+    bool awaitingGlide = false, releasedByRetune = false;
+
+    FmParameters fm;
+    double modulatorPhase = 0.0;
+
+    SyncParameters sync;
+    double syncMasterPhase = 0.0;
+    float pendingSyncBlep = 0.0f;
+
+    NoiseParameters noise;
+    NoiseSource noiseSource;
+    uint32 noiseSeed = 0, numNotesStarted = 0;     // noiseSeed is set once per voice by the synth
+
+    Kernel kernel = Kernel::wavetable;
+    WaveShapeFit kernelShape;
+    KernelUsage* kernelUsage = nullptr;
+    bool kernelChosen = false;
+
+    Lfo lfo;
+    Envelope ampEnvelope, modEnvelope;
+    ControlValues control;
+    int controlCountdown = 0;
+    float noteVelocity = 0.0f;
+
+    static constexpr double crossfadeSeconds = 0.005;
+
+    WavetablePublisher& publisher;
+    WavetableSet* tables = nullptr;
+    WavetableSet* previousTables = nullptr;
+    int crossfadeLength = 1, crossfadeRemaining = 0;
+
+    float* renderBuffer = nullptr;
+    float* crossfadeBuffer = nullptr;
+    float* phaseBuffer = nullptr;
+    float* modulatorBuffer = nullptr;
+    SyncEvent* syncEvents = nullptr;
+    float* noiseBuffer = nullptr;
+    int renderBufferSize = 0;
 };
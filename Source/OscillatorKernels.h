@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    OscillatorKernels.h
+    Created:    18 Oct 2026 3:12:07am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include "WavetableStore.h"
+
+/// The ways a voice can render its oscillator. All of them follow the voice's
+/// one phase, so a voice can switch between them from one run to the next
+/// without a jump in phase.
+enum class Kernel
+{
+    wavetable,  // two mip-mapped tables, interpolated (see MorphReader)
+    additive,   // a SineBank of the partials below Nyquist
+    analytic,   // a naive square or triangle with polyBLEP / polyBLAMP edges
+    sine        // one recursive sine
+};
+
+constexpr int numKernels = (int) Kernel::sine + 1;
+
+/// How many samples each kernel rendered, and how often a voice switched
+/// kernel part way through a note, summed over every voice. The audio thread
+/// adds to it once per run; any thread can read it.
+class KernelUsage
+{
+public:
+    static const char* getName (Kernel kernel) noexcept
+    {
+        static const char* const names[] = { "wavetable", "additive", "analytic", "sine" };
+        return names[(int) kernel];
+    }
+
+    void add (Kernel kernel, int numSamples) noexcept   { samples[(int) kernel].fetch_add (numSamples, std::memory_order_relaxed); }
+    void addSwitch() noexcept                           { switches.fetch_add (1, std::memory_order_relaxed); }
+
+    int64 getNumSamples (Kernel kernel) const noexcept  { return samples[(int) kernel].load (std::memory_order_relaxed); }
+    int64 getNumSwitches() const noexcept               { return switches.load (std::memory_order_relaxed); }
+
+    /// e.g. "kernels: wavetable 60%, additive 10%, analytic 30%, sine 0%, 12 switches"
+    String describe() const
+    {
+        int64 total = 0;
+
+        for (int k = 0; k < numKernels; ++k)
+            total += getNumSamples ((Kernel) k);
+
+        String text ("kernels:");
+
+        for (int k = 0; k < numKernels; ++k)
+            text << (k > 0 ? ", " : " ") << getName ((Kernel) k) << " "
+                 << (total > 0 ? 100 * getNumSamples ((Kernel) k) / total : 0) << "%";
+
+        return text << ", " << getNumSwitches() << " switches";
+    }
+
+private:
+    std::atomic<int64> samples[numKernels] {};
+    std::atomic<int64> switches { 0 };
+};
+
+/// OscillatorKernels picks the cheapest kernel that meets the quality target
+/// for a run of samples, and holds the analytic kernels themselves.
+///
+/// - On a wave recognised as a sine, one recursive sine is exact at any pitch.
+/// - On a square or triangle, the polyBLEP / polyBLAMP kernels alias below
+///   the tables' own error while the note leaves at least
+///   analyticMinHarmonics harmonics below Nyquist, and need no table reads.
+/// - With additiveMaxHarmonics or fewer harmonics below Nyquist, a SineBank is
+///   cheaper and cleaner than interpolating two tables.
+/// - Everything else, including any morph between waves below the additive
+///   region, reads the tables.
+///
+/// Each threshold has some hysteresis, so a note sitting on a boundary (or
+/// gliding slowly across it) doesn't flip between kernels every run.
+struct OscillatorKernels
+{
+    static constexpr double analyticMinHarmonics = 128.0, additiveMaxHarmonics = 8.0;
+    static constexpr double hysteresis = 1.25;
+
+    /// The kernel for a run with this morph ramp and highest increment (radians
+    /// per sample), given the one the voice used last. Fills `shape` for the
+    /// analytic and sine kernels.
+    static Kernel choose (const WavetableSet& set, Kernel current, double morph, double morphStep,
+                          double highestIncrement, WaveShapeFit& shape) noexcept
+    {
+        auto numHarmonics = MathConstants<double>::pi / jmax (highestIncrement, 1.0e-9);
+        shape = {};
+
+        // Only a morph resting on one wave can be that wave's shape
+        if (morphStep == 0.0)
+        {
+            auto scaledPosition = jlimit (0.0, 1.0, morph) * (set.getNumWaves() - 1);
+            auto wave = roundToInt (scaledPosition);
+
+            if (std::abs (scaledPosition - wave) < 1.0e-6)
+                shape = set.getShape (wave);
+        }
+
+        if (shape.shape == WaveShape::sine && numHarmonics >= 1.0)
+            return Kernel::sine;
+
+        auto analyticLimit = current == Kernel::analytic ? analyticMinHarmonics / hysteresis : analyticMinHarmonics;
+
+        if ((shape.shape == WaveShape::square || shape.shape == WaveShape::triangle) && numHarmonics >= analyticLimit)
+            return Kernel::analytic;
+
+        auto additiveLimit = current == Kernel::additive ? additiveMaxHarmonics * hysteresis : additiveMaxHarmonics;
+
+        if (numHarmonics <= additiveLimit)
+            return Kernel::additive;
+
+        return Kernel::wavetable;
+    }
+
+    //==============================================================================
+    /// Renders shape.gain * sin (angle + shape.phase) with one complex phasor,
+    /// from `phase` radians with the increment ramping by incrementStep. Like
+    /// SineBank, the phasor turns by the mean increment so the run ends on the
+    /// same phase as the other kernels.
+    static void renderSine (const WaveShapeFit& shape, float* dest, int numSamples,
+                            double phase, double increment, double incrementStep) noexcept
+    {
+        auto meanIncrement = increment + incrementStep * (numSamples - 1) * 0.5;
+
+        // gain * sin (x) is the real part of -i * gain * e^(ix)
+        auto start = std::polar ((double) shape.gain, phase + shape.phase) * std::complex<double> (0.0, -1.0);
+        auto re = (float) start.real(), im = (float) start.imag();
+        const auto turnRe = (float) std::cos (meanIncrement), turnIm = (float) std::sin (meanIncrement);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            dest[i] = re;
+
+            auto nextRe = re * turnRe - im * turnIm;
+            im = re * turnIm + im * turnRe;
+            re = nextRe;
+        }
+    }
+
+    /// Renders a square or triangle from the phase in `cycles` (as written by
+    /// fillPhaseRamp), with every jump smoothed by a polyBLEP and every corner
+    /// by a polyBLAMP over the two samples around it.
+    static void renderEdges (const WaveShapeFit& shape, float* dest, const float* cycles, int numSamples,
+                             double increment, double incrementStep) noexcept
+    {
+        constexpr auto toCycles = 1.0 / MathConstants<double>::twoPi;
+        auto offset = (float) (shape.phase * toCycles);
+        offset -= std::floor (offset);
+
+        const auto gain = shape.gain;
+        const auto perSample = (float) (increment * toCycles);
+        const auto perSampleStep = (float) (incrementStep * toCycles);
+
+        if (shape.shape == WaveShape::square)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto t = cycles[i] + offset;
+                t -= std::floor (t);
+                auto dt = perSample + perSampleStep * (float) i;
+
+                // Up by 2 at 0, down by 2 at 0.5
+                auto naive = t < 0.5f ? 1.0f : -1.0f;
+                dest[i] = gain * (naive + 2.0f * (stepResidual (t, 0.0f, dt) - stepResidual (t, 0.5f, dt)));
+            }
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto t = cycles[i] + offset;
+                t -= std::floor (t);
+                auto dt = perSample + perSampleStep * (float) i;
+
+                // Slope +4 per cycle turning to -4 at 0.25, and back at 0.75
+                auto naive = t < 0.25f ? 4.0f * t : (t < 0.75f ? 2.0f - 4.0f * t : 4.0f * t - 4.0f);
+                dest[i] = gain * (naive + 8.0f * dt * (rampResidual (t, 0.75f, dt) - rampResidual (t, 0.25f, dt)));
+            }
+        }
+    }
+
+private:
+    /// Distance from phase t to an edge at `edge`, in samples, wrapped to half a cycle either side.
+    static float samplesFrom (float t, float edge, float dt) noexcept
+    {
+        auto distance = t - edge;
+        distance -= std::round (distance);
+        return distance / dt;
+    }
+
+    /// What a unit step at `edge` is missing or has too much of, band-limited
+    /// to a two-sample polynomial (the integral of a triangular pulse).
+    static float stepResidual (float t, float edge, float dt) noexcept
+    {
+        auto x = samplesFrom (t, edge, dt);
+        auto u = jmax (0.0f, 1.0f - std::abs (x));
+        return std::copysign (0.5f * u * u, -x);
+    }
+
+    /// The same for a corner whose slope changes by one per sample: the integral of stepResidual.
+    static float rampResidual (float t, float edge, float dt) noexcept
+    {
+        auto u = jmax (0.0f, 1.0f - std::abs (samplesFrom (t, edge, dt)));
+        return u * u * u / 6.0f;
+    }
+};
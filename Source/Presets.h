@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+    Presets.h
+    Created:    18 Oct 2026 1:36:45am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <vector>
+#include "Modulation.h"
+
+/// Patch is everything that makes up a sound, as one flat, trivially copyable
+/// value: copying it is all it takes to switch sounds, so the audio thread can
+/// take a new one without allocating. See MorphSynth::setPatch().
+struct Patch
+{
+    ModulationParameters modulation;
+    double morph = 0.0;     // 0..1, the first wave of the set to the last
+    double morphY = 0.0;    // 0..1, the vector morph's second axis
+    double level = 1.0;
+};
+
+/// PresetBank keeps named presets as a ValueTree, which is also the file
+/// format, and compiles each one into a Patch as it is added or loaded. Picking
+/// a preset is then just getPatch(), however many there are. Message thread.
+class PresetBank
+{
+public:
+    PresetBank()
+    {
+        add ("Init", {});
+    }
+
+    int getNumPresets() const noexcept                  { return (int) patches.size(); }
+    String getName (int index) const                    { return tree.getChild (index).getProperty (IDs::name).toString(); }
+    const Patch& getPatch (int index) const noexcept    { return patches[(size_t) index]; }
+
+    void add (const String& name, const Patch& patch)
+    {
+        auto preset = toValueTree (patch);
+        preset.setProperty (IDs::name, name, nullptr);
+        tree.appendChild (preset, nullptr);
+        patches.push_back (patch);
+    }
+
+    /// Replaces the bank with the presets in an XML file. Returns false, leaving
+    /// the bank as it was, if the file isn't a preset bank.
+    bool loadFrom (const File& file)
+    {
+        auto xml = parseXML (file);
+
+        if (xml == nullptr)
+            return false;
+
+        auto loaded = ValueTree::fromXml (*xml);
+
+        if (! loaded.hasType (IDs::presets) || loaded.getNumChildren() == 0)
+            return false;
+
+        tree = loaded;
+        patches.clear();
+
+        for (auto preset : tree)
+            patches.push_back (compile (preset));
+
+        return true;
+    }
+
+    bool saveTo (const File& file) const
+    {
+        if (file.getParentDirectory().createDirectory().failed())
+            return false;
+
+        auto xml = tree.createXml();
+        return xml != nullptr && xml->writeTo (file);
+    }
+
+    //==============================================================================
+    static ValueTree toValueTree (const Patch& patch)
+    {
+        const auto& m = patch.modulation;
+
+        ValueTree preset (IDs::preset);
+        preset.setProperty (IDs::morph, patch.morph, nullptr)
+              .setProperty (IDs::morphY, patch.morphY, nullptr)
+              .setProperty (IDs::level, patch.level, nullptr)
+              .setProperty (IDs::morphMode, (int) m.morphMode, nullptr)
+              .setProperty (IDs::oscillatorMode, (int) m.oscillatorMode, nullptr)
+              .setProperty (IDs::lfoShape, (int) m.lfoShape, nullptr)
+              .setProperty (IDs::lfoRate, m.lfoRateHz, nullptr)
+              .setProperty (IDs::pitchBendRange, m.pitchBendRange, nullptr)
+              .setProperty (IDs::glide, m.glideSeconds, nullptr)
+              .setProperty (IDs::controlInterval, m.controlInterval, nullptr);
+
+        preset.appendChild (toValueTree (IDs::ampEnvelope, m.ampEnvelope), nullptr);
+        preset.appendChild (toValueTree (IDs::modEnvelope, m.modEnvelope), nullptr);
+
+        ValueTree fm (IDs::fm);
+        fm.setProperty (IDs::ratio, m.fm.ratio, nullptr)
+          .setProperty (IDs::index, m.fm.index, nullptr)
+          .setProperty (IDs::morph, m.fm.modulatorMorph, nullptr)
+          .setProperty (IDs::bandLimit, (int) m.fm.bandLimit, nullptr);
+        preset.appendChild (fm, nullptr);
+
+        ValueTree sync (IDs::sync);
+        sync.setProperty (IDs::enabled, m.sync.enabled, nullptr)
+            .setProperty (IDs::semitones, m.sync.semitones, nullptr);
+        preset.appendChild (sync, nullptr);
+
+        ValueTree vector (IDs::vector);
+        vector.setProperty (IDs::enabled, m.vector.enabled, nullptr);
+
+        for (int corner = 0; corner < 4; ++corner)
+            vector.setProperty (IDs::corners[corner], m.vector.corners[corner], nullptr);
+
+        preset.appendChild (vector, nullptr);
+
+        ValueTree noise (IDs::noise);
+        noise.setProperty (IDs::colour, (int) m.noise.colour, nullptr)
+             .setProperty (IDs::mix, m.noise.mix, nullptr)
+             .setProperty (IDs::seed, (int) m.noise.seed, nullptr);
+        preset.appendChild (noise, nullptr);
+
+        ValueTree filter (IDs::filter);
+        filter.setProperty (IDs::enabled, m.filter.enabled, nullptr)
+              .setProperty (IDs::response, (int) m.filter.response, nullptr)
+              .setProperty (IDs::cutoff, m.filter.cutoffHz, nullptr)
+              .setProperty (IDs::resonance, m.filter.resonance, nullptr);
+        preset.appendChild (filter, nullptr);
+
+        // Only the routes in use, so presets stay readable and survive new sources or destinations
+        for (int d = 0; d < numModDestinations; ++d)
+        {
+            for (int s = 0; s < numModSources; ++s)
+            {
+                if (m.routes[d][s] == 0.0f)
+                    continue;
+
+                ValueTree route (IDs::route);
+                route.setProperty (IDs::source, s, nullptr)
+                     .setProperty (IDs::destination, d, nullptr)
+                     .setProperty (IDs::depth, m.routes[d][s], nullptr);
+                preset.appendChild (route, nullptr);
+            }
+        }
+
+        return preset;
+    }
+
+    /// Turns a preset into a Patch. Missing values keep their defaults and
+    /// anything out of range is clamped, so a damaged file still gives a playable sound.
+    static Patch compile (const ValueTree& preset)
+    {
+        Patch patch;
+        auto& m = patch.modulation;
+
+        patch.morph = jlimit (0.0, 1.0, (double) preset.getProperty (IDs::morph, patch.morph));
+        patch.morphY = jlimit (0.0, 1.0, (double) preset.getProperty (IDs::morphY, patch.morphY));
+        patch.level = jlimit (0.0, 1.0, (double) preset.getProperty (IDs::level, patch.level));
+        m.morphMode = (MorphMode) jlimit (0, (int) MorphMode::spectral, (int) preset.getProperty (IDs::morphMode, (int) m.morphMode));
+        m.oscillatorMode = (OscillatorMode) jlimit (0, (int) OscillatorMode::automatic,
+                                                    (int) preset.getProperty (IDs::oscillatorMode, (int) m.oscillatorMode));
+        m.lfoShape = (Lfo::Shape) jlimit (0, (int) Lfo::Shape::square, (int) preset.getProperty (IDs::lfoShape, (int) m.lfoShape));
+        m.lfoRateHz = jmax (0.0, (double) preset.getProperty (IDs::lfoRate, m.lfoRateHz));
+        m.pitchBendRange = (float) preset.getProperty (IDs::pitchBendRange, m.pitchBendRange);
+        m.glideSeconds = jmax (0.0, (double) preset.getProperty (IDs::glide, m.glideSeconds));
+        m.controlInterval = jlimit (1, 1024, (int) preset.getProperty (IDs::controlInterval, m.controlInterval));
+
+        m.ampEnvelope = compileEnvelope (preset.getChildWithName (IDs::ampEnvelope), m.ampEnvelope);
+        m.modEnvelope = compileEnvelope (preset.getChildWithName (IDs::modEnvelope), m.modEnvelope);
+
+        auto fm = preset.getChildWithName (IDs::fm);
+        m.fm.ratio = jmax (0.0f, (float) fm.getProperty (IDs::ratio, m.fm.ratio));
+        m.fm.index = jmax (0.0f, (float) fm.getProperty (IDs::index, m.fm.index));
+        m.fm.modulatorMorph = jlimit (0.0, 1.0, (double) fm.getProperty (IDs::morph, m.fm.modulatorMorph));
+        m.fm.bandLimit = (FmParameters::BandLimit) jlimit (0, (int) FmParameters::BandLimit::carsonsRule,
+                                                           (int) fm.getProperty (IDs::bandLimit, (int) m.fm.bandLimit));
+
+        auto sync = preset.getChildWithName (IDs::sync);
+        m.sync.enabled = (bool) sync.getProperty (IDs::enabled, m.sync.enabled);
+        m.sync.semitones = jmax (0.0f, (float) sync.getProperty (IDs::semitones, m.sync.semitones));
+
+        auto vector = preset.getChildWithName (IDs::vector);
+        m.vector.enabled = (bool) vector.getProperty (IDs::enabled, m.vector.enabled);
+
+        for (int corner = 0; corner < 4; ++corner)
+            m.vector.corners[corner] = jlimit (0.0, 1.0, (double) vector.getProperty (IDs::corners[corner], m.vector.corners[corner]));
+
+        auto noise = preset.getChildWithName (IDs::noise);
+        m.noise.colour = (NoiseParameters::Colour) jlimit (0, (int) NoiseParameters::Colour::brown,
+                                                           (int) noise.getProperty (IDs::colour, (int) m.noise.colour));
+        m.noise.mix = jlimit (0.0f, 1.0f, (float) noise.getProperty (IDs::mix, m.noise.mix));
+        m.noise.seed = (uint32) (int) noise.getProperty (IDs::seed, (int) m.noise.seed);
+
+        auto filter = preset.getChildWithName (IDs::filter);
+        m.filter.enabled = (bool) filter.getProperty (IDs::enabled, m.filter.enabled);
+        m.filter.response = (FilterParameters::Response) jlimit (0, (int) FilterParameters::Response::highpass,
+                                                                 (int) filter.getProperty (IDs::response, (int) m.filter.response));
+        m.filter.cutoffHz = jmax (10.0f, (float) filter.getProperty (IDs::cutoff, m.filter.cutoffHz));
+        m.filter.resonance = jlimit (0.0f, 1.0f, (float) filter.getProperty (IDs::resonance, m.filter.resonance));
+
+        for (auto child : preset)
+        {
+            if (! child.hasType (IDs::route))
+                continue;
+
+            auto s = (int) child.getProperty (IDs::source, -1);
+            auto d = (int) child.getProperty (IDs::destination, -1);
+
+            if (isPositiveAndBelow (s, numModSources) && isPositiveAndBelow (d, numModDestinations))
+                m.setRoute ((ModSource) s, (ModDestination) d, (float) child.getProperty (IDs::depth, 0.0f));
+        }
+
+        return patch;
+    }
+
+private:
+    struct IDs
+    {
+        static inline const Identifier presets { "Presets" }, preset { "Preset" }, name { "name" },
+                                       morph { "morph" }, morphY { "morphY" }, level { "level" },
+                                       morphMode { "morphMode" }, oscillatorMode { "oscillatorMode" },
+                                       lfoShape { "lfoShape" }, lfoRate { "lfoRate" },
+                                       pitchBendRange { "pitchBendRange" }, glide { "glide" }, controlInterval { "controlInterval" },
+                                       ampEnvelope { "AmpEnvelope" }, modEnvelope { "ModEnvelope" },
+                                       attack { "attack" }, decay { "decay" }, sustain { "sustain" }, release { "release" },
+                                       fm { "Fm" }, ratio { "ratio" }, index { "index" }, bandLimit { "bandLimit" },
+                                       sync { "Sync" }, enabled { "enabled" }, semitones { "semitones" },
+                                       vector { "Vector" },
+                                       corners[4] { { "bottomLeft" }, { "bottomRight" }, { "topLeft" }, { "topRight" } },
+                                       noise { "Noise" }, colour { "colour" }, mix { "mix" }, seed { "seed" },
+                                       filter { "Filter" }, response { "response" }, cutoff { "cutoff" }, resonance { "resonance" },
+                                       route { "Route" }, source { "source" }, destination { "destination" }, depth { "depth" };
+    };
+
+    static ValueTree toValueTree (const Identifier& type, const Envelope::Parameters& envelope)
+    {
+        ValueTree tree (type);
+        tree.setProperty (IDs::attack, envelope.attackSeconds, nullptr)
+            .setProperty (IDs::decay, envelope.decaySeconds, nullptr)
+            .setProperty (IDs::sustain, envelope.sustainLevel, nullptr)
+            .setProperty (IDs::release, envelope.releaseSeconds, nullptr);
+        return tree;
+    }
+
+    static Envelope::Parameters compileEnvelope (const ValueTree& tree, Envelope::Parameters envelope)
+    {
+        envelope.attackSeconds = jmax (0.0f, (float) tree.getProperty (IDs::attack, envelope.attackSeconds));
+        envelope.decaySeconds = jmax (0.0f, (float) tree.getProperty (IDs::decay, envelope.decaySeconds));
+        envelope.sustainLevel = jlimit (0.0f, 1.0f, (float) tree.getProperty (IDs::sustain, envelope.sustainLevel));
+        envelope.releaseSeconds = jmax (0.0f, (float) tree.getProperty (IDs::release, envelope.releaseSeconds));
+        return envelope;
+    }
+
+    ValueTree tree { IDs::presets };
+    std::vector<Patch> patches;
+};
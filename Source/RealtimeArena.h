@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    RealtimeArena.h
+    Created:    17 Oct 2026 9:14:02am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstring>
+
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC || JUCE_ANDROID || JUCE_IOS
+ #include <sys/mman.h>
+ #define MORPH_ARENA_USES_MMAP 1
+#else
+ #define MORPH_ARENA_USES_MMAP 0
+#endif
+
+/// RealtimeArena is a bump allocator for everything the audio thread touches.
+/// The block is reserved once from prepareToPlay, every page is written so the
+/// OS has to back it before the first note, and it can optionally be locked
+/// into RAM so it never gets paged out again.
+///
+/// An arena with no storage behaves as a dry run: allocate() only advances the
+/// offset and returns nullptr, so the same preparation code can be run once to
+/// measure the footprint and once more to hand out the real memory.
+///
+/// If the block can't be mapped, it comes from the heap instead (still
+/// prefaulted and, if asked, locked). reserve() only fails when the heap
+/// can't provide it either, and callers must then not start rendering.
+class RealtimeArena
+{
+public:
+    static constexpr size_t cacheLineSize = 64;
+
+    RealtimeArena() = default;
+    ~RealtimeArena()    { release(); }
+
+    /// Makes sure at least numBytes are available, prefaulted and zeroed.
+    /// The block only ever grows, so a sample-rate change with the same block
+    /// size reuses the existing pages. Must not be called while the audio
+    /// callback is running. Returns false, leaving the arena empty, if no
+    /// memory could be had at all.
+    bool reserve (size_t numBytes, bool shouldLockMemory)
+    {
+        numBytes = alignUp (jmax (numBytes, (size_t) 1), (size_t) SystemStats::getPageSize());
+
+        if (numBytes > capacity || shouldLockMemory != wantsLock)
+        {
+            release();
+
+           #if MORPH_ARENA_USES_MMAP
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+           #if JUCE_LINUX || JUCE_ANDROID
+            flags |= MAP_POPULATE;
+           #endif
+            auto* block = mmap (nullptr, numBytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+            storage = (block == MAP_FAILED) ? nullptr : static_cast<char*> (block);
+            mapped = storage != nullptr;
+           #endif
+
+            // Not mapped: an ordinary heap block, aligned by hand
+            if (storage == nullptr)
+            {
+                fallbackStorage.allocate (numBytes + cacheLineSize, false);
+                storage = fallbackStorage.get();
+
+                if (storage != nullptr)
+                    storage += alignUp ((size_t) (pointer_sized_int) storage, cacheLineSize) - (size_t) (pointer_sized_int) storage;
+            }
+
+            if (storage == nullptr)
+            {
+                jassertfalse;
+                return false;
+            }
+
+            capacity = numBytes;
+            wantsLock = shouldLockMemory;
+
+           #if MORPH_ARENA_USES_MMAP
+            if (wantsLock)
+            {
+                locked = mlock (storage, capacity) == 0;
+
+                if (! locked)
+                    DBG ("RealtimeArena: mlock failed, check RLIMIT_MEMLOCK (ulimit -l)");
+            }
+           #endif
+        }
+
+        // Writing every byte is what actually prefaults the pages (MAP_POPULATE is only a hint)
+        std::memset (storage, 0, capacity);
+        used = 0;
+        return true;
+    }
+
+    /// Frees the block. Only call this when the audio callback is stopped.
+    void release()
+    {
+        if (storage != nullptr)
+        {
+           #if MORPH_ARENA_USES_MMAP
+            if (locked)
+                munlock (storage, capacity);
+
+            if (mapped)
+                munmap (storage, capacity);
+           #endif
+
+            fallbackStorage.free();
+        }
+
+        storage = nullptr;
+        capacity = used = 0;
+        locked = mapped = false;
+    }
+
+    /// Forgets every allocation without touching the pages, ready for another preparation pass.
+    void rewind() noexcept      { used = 0; }
+
+    /// Hands out numElements uninitialised objects from the block.
+    /// Returns nullptr when measuring or when the arena has run out.
+    template <typename Type>
+    Type* allocate (size_t numElements, size_t alignment = cacheLineSize) noexcept
+    {
+        static_assert (std::is_trivially_destructible_v<Type>, "The arena never runs destructors");
+
+        auto offset = alignUp (used, jmax (alignment, alignof (Type)));
+        auto bytes = numElements * sizeof (Type);
+        used = offset + bytes;
+
+        if (storage == nullptr || used > capacity)
+        {
+            jassert (storage == nullptr);
+            return nullptr;
+        }
+
+        return reinterpret_cast<Type*> (storage + offset);
+    }
+
+    size_t getBytesUsed() const noexcept    { return used; }
+    size_t getCapacity() const noexcept     { return capacity; }
+    bool isLocked() const noexcept          { return locked; }
+
+    static size_t alignUp (size_t value, size_t alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+private:
+    char* storage = nullptr;
+    size_t capacity = 0, used = 0;
+    bool wantsLock = false, locked = false, mapped = false;
+    HeapBlock<char> fallbackStorage;
+
+    JUCE_DECLARE_NON_COPYABLE (RealtimeArena)
+};
@@ -0,0 +1,334 @@
+/*
+  ==============================================================================
+
+    RenderAhead.h
+    Created:    17 Oct 2026 6:47:05pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include "RealtimeArena.h"
+#include "ThreadTuning.h"
+
+#if JUCE_LINUX || JUCE_ANDROID
+ #include <cerrno>
+ #include <semaphore.h>
+ #define MORPH_RENDER_AHEAD_USES_SEMAPHORE 1
+#else
+ #define MORPH_RENDER_AHEAD_USES_SEMAPHORE 0
+#endif
+
+/// RenderAhead lets a worker thread render a configurable number of blocks
+/// ahead of the audio device into a lock-free ring, so the device callback
+/// only copies samples out and a load spike has the whole ring to hide in.
+/// That is meant for scheduled playback (MIDI file players, installations):
+/// live MIDI is delayed by the ahead depth and quantised to whole blocks.
+///
+/// Exactly one thread renders at any time and the hand-over always happens on
+/// a sample boundary, so switching on and off is seamless:
+///  - switching on, the audio thread keeps rendering and adds one extra block
+///    to the ring per callback; once the ring is deep enough the worker takes
+///    over.
+///  - switching off, the worker stops after its current block and the audio
+///    thread plays out what is left in the ring before rendering directly.
+///
+/// With a depth of 0 and an empty ring, process() just calls the render
+/// function on the device buffer, so interactive playback pays nothing: the
+/// worker isn't started until a depth is first set.
+///
+/// The worker sleeps while the ring is full. The audio callback wakes it
+/// without taking a lock, and only once the ring has drained a block below the
+/// wanted depth. On Linux the wake-up is a POSIX semaphore, whose post is a
+/// futex. Elsewhere there is no lock-free equivalent, so the worker polls
+/// every pollMilliseconds instead.
+class RenderAhead final : private Thread
+{
+public:
+    /// Renders (overwrites) numSamples into a buffer that starts at sample 0,
+    /// including MIDI collection. Called on whichever thread currently renders.
+    using RenderFunction = std::function<void (AudioBuffer<float>&, int numSamples)>;
+
+    static constexpr int numChannels = 2;
+
+    static constexpr int pollMilliseconds = 1;
+
+    RenderAhead (const EngineSettings& settingsToUse, RenderFunction renderFunctionToUse)
+        : Thread ("Render ahead"),
+          settings (settingsToUse),
+          renderFunction (std::move (renderFunctionToUse))
+    {
+       #if MORPH_RENDER_AHEAD_USES_SEMAPHORE
+        sem_init (&workAvailable, 0, 0);
+       #endif
+    }
+
+    ~RenderAhead() override
+    {
+        stop();
+
+       #if MORPH_RENDER_AHEAD_USES_SEMAPHORE
+        sem_destroy (&workAvailable);
+       #endif
+    }
+
+    /// Hands out the ring from `arena` (which may be a dry run); call from
+    /// prepareToPlay with the worker stopped. Room is reserved for
+    /// settings.maxRenderAheadBlocks blocks of blockSize samples.
+    void allocate (RealtimeArena& arena, int blockSizeToUse)
+    {
+        jassert (! isThreadRunning());
+
+        blockSize = jmax (1, blockSizeToUse);
+        capacity = (settings.maxRenderAheadBlocks + 2) * blockSize;
+
+        for (auto& channel : ring)
+            channel = arena.allocate<float> ((size_t) capacity);
+
+        for (auto& channel : scratch)
+            channel = arena.allocate<float> ((size_t) blockSize);
+    }
+
+    /// Call once the ring has been allocated for real. Starts the worker if a
+    /// depth is already set.
+    void start()
+    {
+        fifo.setTotalSize (capacity);
+        fifo.reset();
+        mode.store (Mode::direct, std::memory_order_release);
+        prepared = true;
+
+        if (getDepth() > 0)
+            startThread (Priority::highest);
+    }
+
+    /// Stops the worker and drops anything still in the ring.
+    void stop()
+    {
+        prepared = false;
+        signalThreadShouldExit();
+        wakeWorker();
+        stopThread (2000);
+        mode.store (Mode::direct, std::memory_order_release);
+        fifo.reset();
+    }
+
+    /// Message thread: how many blocks to keep rendered ahead; 0 switches the
+    /// mode off. The worker is started the first time this is above 0.
+    void setDepth (int numBlocks)
+    {
+        depthBlocks.store (jlimit (0, settings.maxRenderAheadBlocks, numBlocks), std::memory_order_relaxed);
+
+        if (prepared && getDepth() > 0 && ! isThreadRunning())
+            startThread (Priority::highest);
+    }
+
+    int getDepth() const noexcept               { return depthBlocks.load (std::memory_order_relaxed); }
+    bool isWorkerRendering() const noexcept     { return mode.load (std::memory_order_acquire) != Mode::direct; }
+    int64 getNumUnderruns() const noexcept      { return numUnderruns.load (std::memory_order_relaxed); }
+    const ThreadTuning::Report& getWorkerReport() const noexcept { return workerReport; }
+
+    /// Audio thread: fills (overwrites) numSamples of `buffer` from startSample.
+    void process (AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        while (numSamples > 0)
+        {
+            auto chunk = jmin (numSamples, blockSize);
+            processChunk (buffer, startSample, chunk);
+            startSample += chunk;
+            numSamples -= chunk;
+        }
+    }
+
+private:
+    enum class Mode
+    {
+        direct,     // the audio thread renders
+        ahead,      // the worker renders
+        stopping    // the worker finishes its block, then hands back to the audio thread
+    };
+
+    void processChunk (AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        auto wantedDepth = depthBlocks.load (std::memory_order_relaxed);
+        auto current = mode.load (std::memory_order_acquire);
+
+        if (current == Mode::direct)
+        {
+            if (wantedDepth > 0)
+            {
+                // Priming: keep rendering here, one block more than is played per callback
+                auto wanted = fifo.getNumReady() + numSamples + blockSize;
+
+                while (fifo.getNumReady() < wanted && fifo.getFreeSpace() >= blockSize)
+                    renderIntoRing();
+
+                readFromRing (buffer, startSample, numSamples);
+
+                if (fifo.getNumReady() >= wantedDepth * blockSize)
+                {
+                    mode.store (Mode::ahead, std::memory_order_release);
+                    wakeWorker();
+                }
+
+                return;
+            }
+
+            // Play out what the worker left behind, then render straight into the device buffer
+            auto numRead = readFromRing (buffer, startSample, numSamples);
+
+            if (numRead < numSamples)
+                renderDirect (buffer, startSample + numRead, numSamples - numRead);
+
+            return;
+        }
+
+        if (wantedDepth == 0 && current == Mode::ahead)
+            mode.compare_exchange_strong (current, Mode::stopping, std::memory_order_acq_rel);
+        else if (wantedDepth > 0 && current == Mode::stopping)
+            mode.compare_exchange_strong (current, Mode::ahead, std::memory_order_acq_rel);
+
+        auto numRead = readFromRing (buffer, startSample, numSamples);
+
+        // The worker fell behind; it owns the synth, so all we can do is output silence
+        if (numRead < numSamples)
+        {
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                buffer.clear (ch, startSample + numRead, numSamples - numRead);
+
+            numUnderruns.store (numUnderruns.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        // A hand-back to finish, or at least a whole block to refill
+        if (mode.load (std::memory_order_acquire) == Mode::stopping
+             || fifo.getNumReady() <= (wantedDepth - 1) * blockSize)
+            wakeWorker();
+    }
+
+    /// Any thread, including the audio thread: wakes the worker if it is
+    /// asleep. Never locks; posts at most once per sleep.
+    void wakeWorker() noexcept
+    {
+        if (workerAsleep.exchange (false, std::memory_order_acq_rel))
+        {
+           #if MORPH_RENDER_AHEAD_USES_SEMAPHORE
+            sem_post (&workAvailable);
+           #endif
+        }
+    }
+
+    /// Worker: whether there is a block to render or a hand-back to finish.
+    bool hasWork() const noexcept
+    {
+        auto current = mode.load (std::memory_order_acquire);
+
+        return current == Mode::stopping
+            || (current == Mode::ahead && fifo.getNumReady() < getDepth() * blockSize && fifo.getFreeSpace() >= blockSize);
+    }
+
+    /// Worker: sleeps until wakeWorker(), or for one poll period where posting isn't lock-free.
+    void sleepUntilWoken()
+    {
+        workerAsleep.store (true, std::memory_order_seq_cst);
+
+        // Work (or stop()) that arrived before the flag was set wouldn't have posted
+        if ((hasWork() || threadShouldExit()) && workerAsleep.exchange (false, std::memory_order_acq_rel))
+            return;
+
+       #if MORPH_RENDER_AHEAD_USES_SEMAPHORE
+        while (sem_wait (&workAvailable) != 0 && errno == EINTR) {}
+       #else
+        wait (pollMilliseconds);
+        workerAsleep.store (false, std::memory_order_relaxed);
+       #endif
+    }
+
+    void run() override
+    {
+        ThreadTuning::tuneRealtimeThread (settings, workerReport);
+
+        while (! threadShouldExit())
+        {
+            auto current = mode.load (std::memory_order_acquire);
+
+            if (current == Mode::stopping)
+            {
+                mode.compare_exchange_strong (current, Mode::direct, std::memory_order_acq_rel);
+            }
+            else if (current == Mode::ahead)
+            {
+                while (fifo.getNumReady() < getDepth() * blockSize
+                        && fifo.getFreeSpace() >= blockSize
+                        && mode.load (std::memory_order_acquire) == Mode::ahead
+                        && ! threadShouldExit())
+                    renderIntoRing();
+            }
+
+            if (! threadShouldExit())
+                sleepUntilWoken();
+        }
+    }
+
+    /// Renders one block into the scratch buffer and appends it to the ring.
+    void renderIntoRing() noexcept
+    {
+        AudioBuffer<float> block (scratch, numChannels, blockSize);
+        renderFunction (block, blockSize);
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (blockSize, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            FloatVectorOperations::copy (ring[ch] + start1, scratch[ch], size1);
+            FloatVectorOperations::copy (ring[ch] + start2, scratch[ch] + size1, size2);
+        }
+
+        fifo.finishedWrite (size1 + size2);
+    }
+
+    int readFromRing (AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* source = ring[jmin (ch, numChannels - 1)];
+            FloatVectorOperations::copy (buffer.getWritePointer (ch, startSample), source + start1, size1);
+            FloatVectorOperations::copy (buffer.getWritePointer (ch, startSample + size1), source + start2, size2);
+        }
+
+        fifo.finishedRead (size1 + size2);
+        return size1 + size2;
+    }
+
+    void renderDirect (AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        AudioBuffer<float> view (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), startSample, numSamples);
+        renderFunction (view, numSamples);
+    }
+
+    const EngineSettings& settings;
+    RenderFunction renderFunction;
+
+    int blockSize = 1, capacity = 1;
+    std::atomic<bool> prepared { false }, workerAsleep { false };
+
+   #if MORPH_RENDER_AHEAD_USES_SEMAPHORE
+    sem_t workAvailable;
+   #endif
+
+    float* ring[numChannels] {};
+    float* scratch[numChannels] {};
+    AbstractFifo fifo { 1 };
+
+    std::atomic<Mode> mode { Mode::direct };
+    std::atomic<int> depthBlocks { 0 };
+    std::atomic<int64> numUnderruns { 0 };
+    ThreadTuning::Report workerReport;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderAhead)
+};
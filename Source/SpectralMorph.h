@@ -0,0 +1,264 @@
+/*
+  ==============================================================================
+
+    SpectralMorph.h
+    Created:    18 Oct 2026 2:04:37am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>
+#include <functional>
+#include <vector>
+#include "WavetablePublisher.h"
+
+/// SpectralMorph resynthesises a WavetableSet so that morphing between its
+/// waves moves through the harmonic domain instead of crossfading samples.
+///
+/// A linear crossfade between two waves sums their harmonics with whatever
+/// phases they happen to have, so halfway between a square and a triangle
+/// some harmonics partly cancel and the sound goes hollow. Here every wave is
+/// analysed into harmonic magnitudes and phases once, and frames in between
+/// are built by interpolating the magnitudes linearly and the phases along
+/// the shorter arc, then band-limiting each frame into every mip with an
+/// inverse dsp::FFT.
+///
+/// Each voice has its own (modulated) morph position, so rather than follow
+/// one position around, a background thread resynthesises a dense grid of
+/// frames (getStepsPerSegment() between each pair of waves) whenever the set
+/// changes. The grid is published like any other set, RCU style, and voices
+/// in MorphMode::spectral read it instead of the set itself. Neighbouring
+/// frames are so close that the crossfade between them no longer cancels
+/// anything. Until the grid for the current set is ready, voices keep playing
+/// the plain set.
+class SpectralMorph final : private Thread
+{
+public:
+    /// Frames across the whole morph range; sets with more waves than this are
+    /// already dense enough and are played as they are.
+    static constexpr int targetFrames = 64;
+
+    SpectralMorph (WavetableStore& storeToUse, WavetableSet::Ptr initialSource)
+        : Thread ("Spectral morph"),
+          frames (storeToUse, initialSource)
+    {
+        setSource (std::move (initialSource));
+        startThread (Priority::background);
+    }
+
+    ~SpectralMorph() override
+    {
+        stopThread (4000);
+    }
+
+    /// Message thread: the set to resynthesise, normally WavetablePublisher::getCurrent().
+    void setSource (WavetableSet::Ptr newSource)
+    {
+        {
+            const ScopedLock sl (sourceLock);
+            pendingSource = std::move (newSource);
+        }
+
+        notify();
+    }
+
+    /// Audio thread: the frames resynthesised from `source`, or nullptr if
+    /// they aren't ready. Valid until the next markBlockBoundary(), like
+    /// WavetablePublisher::getActive().
+    WavetableSet* getFramesFor (const WavetableSet& source) const noexcept
+    {
+        auto* built = published.load (std::memory_order_acquire);
+
+        if (built == nullptr || built->sourceHash != source.getContentHash())
+            return nullptr;
+
+        return built->frames.get();
+    }
+
+    /// Audio thread: call once after every rendered block.
+    void markBlockBoundary() noexcept       { frames.markBlockBoundary(); }
+
+    /// See WavetablePublisher::setReaderActive().
+    void setReaderActive (bool shouldBeActive)     { frames.setReaderActive (shouldBeActive); }
+
+    static int getStepsPerSegment (int numWaves) noexcept
+    {
+        return numWaves > 1 ? (targetFrames + numWaves - 2) / (numWaves - 1) : 0;
+    }
+
+    /// Builds the grid of frames for `source`. Returns nullptr for sets that
+    /// don't need one (a single wave, or already dense), for sparse sets, or if
+    /// shouldStop returns true part way through.
+    static WavetableSet::Ptr createFrames (const WavetableSet& source, const std::function<bool()>& shouldStop = {})
+    {
+        auto numWaves = source.getNumWaves();
+        auto steps = getStepsPerSegment (numWaves);
+
+        if (steps <= 1 || source.isSparse())
+            return nullptr;
+
+        auto tableSize = source.getTableSize();
+        auto numBins = tableSize / 2 + 1;
+        dsp::FFT fft ((int) std::log2 (tableSize));
+
+        HeapBlock<float> spectrum ((size_t) tableSize * 2, true), work ((size_t) tableSize * 2, true);
+        HeapBlock<float> magnitudes ((size_t) (numWaves * numBins)), phases ((size_t) (numWaves * numBins));
+
+        // Mip 0 already holds every harmonic, scaled the way the set plays it
+        for (int wave = 0; wave < numWaves; ++wave)
+        {
+            WavetableBuilder::forwardTransform (fft, source.getTable (wave, 0), spectrum, tableSize);
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                magnitudes[wave * numBins + bin] = std::hypot (spectrum[2 * bin], spectrum[2 * bin + 1]);
+                phases[wave * numBins + bin] = std::atan2 (spectrum[2 * bin + 1], spectrum[2 * bin]);
+            }
+        }
+
+        auto numFrames = (numWaves - 1) * steps + 1;
+        WavetableSet::Ptr set = new WavetableSet (numFrames, tableSize);
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            if (shouldStop && shouldStop())
+                return nullptr;
+
+            auto segment = jmin (frame / steps, numWaves - 2);
+            auto position = (float) (frame - segment * steps) / (float) steps;
+            interpolateSpectrum (magnitudes + segment * numBins, phases + segment * numBins,
+                                 magnitudes + (segment + 1) * numBins, phases + (segment + 1) * numBins,
+                                 position, numBins, spectrum);
+
+            for (int mip = 0; mip < set->getNumMips(); ++mip)
+                WavetableBuilder::writeBandLimited (fft, spectrum, work, set->getWritePointer (frame, mip),
+                                                    tableSize, set->getNumHarmonics (mip));
+        }
+
+        return set;
+    }
+
+private:
+    /// Writes the spectrum `position` of the way from wave a to wave b into
+    /// spectrum, as interleaved re/im bins.
+    static void interpolateSpectrum (const float* magnitudesA, const float* phasesA,
+                                     const float* magnitudesB, const float* phasesB,
+                                     float position, int numBins, float* spectrum) noexcept
+    {
+        constexpr auto pi = MathConstants<float>::pi;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            auto a = magnitudesA[bin], b = magnitudesB[bin];
+            auto magnitude = a + position * (b - a);
+
+            // A harmonic 60 dB below its partner has no phase worth keeping
+            float phase;
+
+            if (a < 0.001f * b)
+                phase = phasesB[bin];
+            else if (b < 0.001f * a)
+                phase = phasesA[bin];
+            else
+                phase = phasesA[bin] + position * (std::remainder (phasesB[bin] - phasesA[bin], 2.0f * pi));
+
+            spectrum[2 * bin] = magnitude * std::cos (phase);
+            spectrum[2 * bin + 1] = magnitude * std::sin (phase);
+        }
+
+        spectrum[0] = spectrum[1] = 0.0f;
+    }
+
+    /// The frames built from one source, together with that source's hash, so
+    /// readers check the hash and take the frames from a single load.
+    struct BuiltFrames final : public ReferenceCountedObject
+    {
+        using Ptr = ReferenceCountedObjectPtr<BuiltFrames>;
+
+        BuiltFrames (uint64 sourceHashIn, WavetableSet::Ptr framesIn)
+            : sourceHash (sourceHashIn), frames (std::move (framesIn)) {}
+
+        const uint64 sourceHash;
+        const WavetableSet::Ptr frames;
+    };
+
+    struct RetiredFrames
+    {
+        BuiltFrames::Ptr built;
+        uint64 retiredAtEpoch;
+    };
+
+    /// Swaps in the next frames, or nullptr if the source has none. The old ones
+    /// are retired against the frames publisher's epoch, like its sets.
+    void publishFrames (BuiltFrames::Ptr next)
+    {
+        auto replaced = current;
+        current = std::move (next);
+        published.store (current.get(), std::memory_order_release);
+
+        if (replaced != nullptr)
+            retired.push_back ({ std::move (replaced), frames.getEpoch() });
+    }
+
+    void reclaimFrames()
+    {
+        auto now = frames.getEpoch();
+
+        retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                       [now] (const RetiredFrames& r) { return now > r.retiredAtEpoch; }),
+                       retired.end());
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            // Polls only while something retired is waiting for a block boundary
+            wait (retired.empty() ? -1 : 250);
+            ThreadTuning::keepOffRealtimeCores();
+            reclaimFrames();
+
+            WavetableSet::Ptr source;
+            {
+                const ScopedLock sl (sourceLock);
+                source = std::move (pendingSource);
+                pendingSource = nullptr;
+            }
+
+            if (source == nullptr || source->getContentHash() == builtFromHash)
+                continue;
+
+            auto newFrames = createFrames (*source, [this] { return threadShouldExit(); });
+
+            if (threadShouldExit())
+                return;
+
+            // The hash travels with the frames, so no voice pairs old frames with a new set
+            if (newFrames != nullptr)
+            {
+                frames.publish (newFrames);
+                publishFrames (new BuiltFrames (source->getContentHash(), frames.getCurrent()));
+            }
+            else
+            {
+                publishFrames (nullptr);
+            }
+
+            builtFromHash = source->getContentHash();
+        }
+    }
+
+    /// Only this class's thread publishes, so it is the publisher's single writer.
+    /// It also supplies the epoch that BuiltFrames are retired against.
+    WavetablePublisher frames;
+    BuiltFrames::Ptr current;
+    std::atomic<BuiltFrames*> published { nullptr };
+    std::vector<RetiredFrames> retired;
+    uint64 builtFromHash = 0;
+
+    CriticalSection sourceLock;
+    WavetableSet::Ptr pendingSource;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectralMorph)
+};
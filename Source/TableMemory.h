@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    TableMemory.h
+    Created:    17 Oct 2026 1:32:09pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstring>
+#include <memory>
+#include "RealtimeArena.h"
+
+#if JUCE_LINUX || JUCE_ANDROID
+ #include <sys/mman.h>
+ #define MORPH_TABLES_CAN_USE_HUGE_PAGES 1
+#else
+ #define MORPH_TABLES_CAN_USE_HUGE_PAGES 0
+#endif
+
+/// TableMemory is a zeroed, 64-byte aligned block of floats for wavetable data.
+/// Large libraries are dominated by TLB misses, so on Linux the block can be
+/// backed by 2 MB pages: explicit ones from the hugetlbfs pool (MAP_HUGETLB)
+/// or transparent ones (madvise(MADV_HUGEPAGE)). Requests fall back one step
+/// at a time (explicit -> transparent -> standard pages) and the backing that
+/// was actually obtained is reported by getBacking().
+///
+/// A block can also map a file read-only (see createMapped()), which is how
+/// tables from the WavetableImporter's disk cache are loaded without copying.
+class TableMemory final : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<TableMemory>;
+
+    enum class Backing
+    {
+        standardPages,
+        transparentHugePages,
+        explicitHugePages,
+        mappedFile          // only reported, by blocks from createMapped()
+    };
+
+    static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+    TableMemory (size_t numFloats, Backing requested = Backing::standardPages)
+        : numBytes (jmax ((size_t) 1, numFloats) * sizeof (float))
+    {
+       #if MORPH_TABLES_CAN_USE_HUGE_PAGES
+        if (requested == Backing::explicitHugePages && allocateExplicitHugePages())
+            return;
+
+        if (requested != Backing::standardPages && allocateTransparentHugePages())
+            return;
+       #else
+        ignoreUnused (requested);
+       #endif
+
+        allocateStandardPages();
+    }
+
+    /// Maps `file` read-only and views the floats starting at byteOffset, which
+    /// must be a multiple of 64. Returns nullptr if the file can't be mapped.
+    /// The data must never be written through getData().
+    static Ptr createMapped (const File& file, size_t byteOffset)
+    {
+        jassert (byteOffset % RealtimeArena::cacheLineSize == 0);
+
+        auto mapping = std::make_unique<MemoryMappedFile> (file, MemoryMappedFile::readOnly);
+
+        if (mapping->getData() == nullptr || mapping->getSize() <= byteOffset)
+            return nullptr;
+
+        Ptr memory = new TableMemory (mapping->getSize() - byteOffset, std::move (mapping), byteOffset);
+
+        // Fault the pages in now rather than on the audio thread's first lookup
+        auto* bytes = reinterpret_cast<const volatile char*> (memory->getData());
+        for (size_t offset = 0; offset < memory->getNumBytes(); offset += 4096)
+            ignoreUnused (bytes[offset]);
+
+        return memory;
+    }
+
+    ~TableMemory() override
+    {
+       #if MORPH_TABLES_CAN_USE_HUGE_PAGES
+        if (mappedBase != nullptr)
+            munmap (mappedBase, mappedBytes);
+       #endif
+    }
+
+    float* getData() const noexcept         { return data; }
+    size_t getNumBytes() const noexcept     { return numBytes; }
+    Backing getBacking() const noexcept     { return backing; }
+
+    static String getBackingName (Backing b)
+    {
+        switch (b)
+        {
+            case Backing::explicitHugePages:    return "explicit 2 MB pages";
+            case Backing::transparentHugePages: return "transparent huge pages";
+            case Backing::mappedFile:           return "memory-mapped file";
+            case Backing::standardPages:        break;
+        }
+
+        return "standard pages";
+    }
+
+private:
+    TableMemory (size_t mappedBytesIn, std::unique_ptr<MemoryMappedFile> mapping, size_t byteOffset)
+        : numBytes (mappedBytesIn),
+          mappedFile (std::move (mapping)),
+          data (reinterpret_cast<float*> (static_cast<char*> (mappedFile->getData()) + byteOffset)),
+          backing (Backing::mappedFile)
+    {
+    }
+
+   #if MORPH_TABLES_CAN_USE_HUGE_PAGES
+    bool allocateExplicitHugePages()
+    {
+        auto bytes = RealtimeArena::alignUp (numBytes, hugePageSize);
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+       #ifdef MAP_HUGE_2MB
+        flags |= MAP_HUGE_2MB;
+       #endif
+
+        // Fails unless vm.nr_hugepages has reserved enough pages
+        auto* block = mmap (nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+        if (block == MAP_FAILED)
+            return false;
+
+        adoptMapping (block, bytes, block, Backing::explicitHugePages);
+        return true;
+    }
+
+    bool allocateTransparentHugePages()
+    {
+       #ifdef MADV_HUGEPAGE
+        // Over-allocate so the usable range can start on a 2 MB boundary
+        auto bytes = RealtimeArena::alignUp (numBytes, hugePageSize) + hugePageSize;
+        auto* block = mmap (nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (block == MAP_FAILED)
+            return false;
+
+        auto address = (size_t) (pointer_sized_int) block;
+        auto* aligned = static_cast<char*> (block) + (RealtimeArena::alignUp (address, hugePageSize) - address);
+
+        // Fails when THP is disabled system-wide ("never" in /sys/kernel/mm/transparent_hugepage/enabled)
+        if (madvise (aligned, RealtimeArena::alignUp (numBytes, hugePageSize), MADV_HUGEPAGE) != 0)
+        {
+            munmap (block, bytes);
+            return false;
+        }
+
+        adoptMapping (block, bytes, aligned, Backing::transparentHugePages);
+        return true;
+       #else
+        return false;
+       #endif
+    }
+
+    void adoptMapping (void* base, size_t bytes, void* usable, Backing obtained)
+    {
+        mappedBase = base;
+        mappedBytes = bytes;
+        data = static_cast<float*> (usable);
+        backing = obtained;
+
+        // Fault the pages in now rather than on the first lookup
+        std::memset (data, 0, numBytes);
+    }
+
+    void* mappedBase = nullptr;
+    size_t mappedBytes = 0;
+   #endif
+
+    void allocateStandardPages()
+    {
+        heapStorage.calloc (numBytes + RealtimeArena::cacheLineSize);
+        auto address = (size_t) (pointer_sized_int) heapStorage.get();
+        data = reinterpret_cast<float*> (heapStorage.get() + (RealtimeArena::alignUp (address, RealtimeArena::cacheLineSize) - address));
+        backing = Backing::standardPages;
+    }
+
+    const size_t numBytes;
+    HeapBlock<char> heapStorage;
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+    float* data = nullptr;
+    Backing backing = Backing::standardPages;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TableMemory)
+};
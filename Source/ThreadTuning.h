@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    ThreadTuning.h
+    Created:    17 Oct 2026 5:58:16pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include "EngineSettings.h"
+
+#if JUCE_LINUX || JUCE_ANDROID
+ #include <cerrno>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <sys/resource.h>
+ #define MORPH_CAN_TUNE_THREADS 1
+#else
+ #define MORPH_CAN_TUNE_THREADS 0
+#endif
+
+/// ThreadTuning applies the scheduling and CPU affinity parts of
+/// EngineSettings.
+///
+/// Realtime threads (the audio callback and render workers) call
+/// tuneRealtimeThread() on themselves; it only makes system calls, so it is
+/// safe to run once from the first callback. Everything else (the message
+/// thread and background loaders) calls keepOffRealtimeCores() every now and
+/// then, which is a single atomic load unless the realtime cores have changed.
+struct ThreadTuning
+{
+    /// What happened when a thread tried to apply the settings. Written by that
+    /// thread, read (and described) on the message thread.
+    struct Report
+    {
+        static constexpr int notApplied = -1;
+
+        std::atomic<int> schedulingError { notApplied }, affinityError { notApplied };
+
+        String describe (const EngineSettings& settings) const
+        {
+            return describeSchedulingError (schedulingError.load(), settings) + ", "
+                 + describeAffinityError (affinityError.load(), settings.realtimeCoreMask);
+        }
+    };
+
+    /// Applies the realtime policy and core mask to the calling thread.
+    static void tuneRealtimeThread (const EngineSettings& settings, Report& report) noexcept
+    {
+        if (settings.realtimePolicy != EngineSettings::RealtimePolicy::inherit)
+            report.schedulingError = makeCurrentThreadRealtime (settings.realtimePolicy, settings.realtimePriority);
+
+        if (settings.realtimeCoreMask != 0)
+            report.affinityError = pinCurrentThread (settings.realtimeCoreMask);
+    }
+
+    /// Returns 0 or the errno from pthread_setschedparam.
+    static int makeCurrentThreadRealtime (EngineSettings::RealtimePolicy policy, int priority) noexcept
+    {
+       #if MORPH_CAN_TUNE_THREADS
+        auto schedPolicy = policy == EngineSettings::RealtimePolicy::roundRobin ? SCHED_RR : SCHED_FIFO;
+
+        sched_param param {};
+        param.sched_priority = jlimit (sched_get_priority_min (schedPolicy), sched_get_priority_max (schedPolicy), priority);
+
+        return pthread_setschedparam (pthread_self(), schedPolicy, &param);
+       #else
+        ignoreUnused (policy, priority);
+        return unsupported;
+       #endif
+    }
+
+    /// Restricts the calling thread to the cores in coreMask (bit n = core n).
+    /// Returns 0 or the errno from sched_setaffinity.
+    static int pinCurrentThread (uint64 coreMask) noexcept
+    {
+       #if MORPH_CAN_TUNE_THREADS
+        cpu_set_t cpus;
+        CPU_ZERO (&cpus);
+
+        for (int core = 0; core < 64; ++core)
+            if ((coreMask & ((uint64) 1 << core)) != 0)
+                CPU_SET (core, &cpus);
+
+        return sched_setaffinity (0, sizeof (cpus), &cpus) == 0 ? 0 : errno;
+       #else
+        ignoreUnused (coreMask);
+        return unsupported;
+       #endif
+    }
+
+    /// Every core the machine has, as a mask.
+    static uint64 getAllCoresMask() noexcept
+    {
+        auto numCores = jlimit (1, 64, SystemStats::getNumCpus());
+        return numCores == 64 ? ~(uint64) 0 : (((uint64) 1 << numCores) - 1);
+    }
+
+    /// Message thread: records which cores realtime threads are pinned to.
+    /// Background threads move off them at their next keepOffRealtimeCores().
+    static void setRealtimeCores (uint64 coreMask) noexcept
+    {
+        if (getRealtimeCoreMask().exchange (coreMask) != coreMask)
+            ++getGeneration();
+    }
+
+    /// Call from the message thread and at the top of background thread loops.
+    static void keepOffRealtimeCores() noexcept
+    {
+        thread_local uint32 appliedGeneration = 0;
+        auto generation = getGeneration().load();
+
+        if (generation == appliedGeneration)
+            return;
+
+        appliedGeneration = generation;
+        auto others = getAllCoresMask() & ~getRealtimeCoreMask().load();
+
+        // If the realtime threads were given every core, share them rather than starve
+        pinCurrentThread (others != 0 ? others : getAllCoresMask());
+    }
+
+    static String describeSchedulingError (int error, const EngineSettings& settings)
+    {
+        auto name = String (settings.realtimePolicy == EngineSettings::RealtimePolicy::roundRobin ? "SCHED_RR" : "SCHED_FIFO")
+                      + " " + String (settings.realtimePriority);
+
+        if (error == Report::notApplied)
+            return "device scheduling";
+
+        if (error == 0)
+            return name;
+
+        if (error == unsupported)
+            return name + " unsupported on this platform";
+
+       #if MORPH_CAN_TUNE_THREADS
+        if (error == EPERM)
+        {
+            rlimit limit {};
+            getrlimit (RLIMIT_RTPRIO, &limit);
+
+            return name + " denied: RLIMIT_RTPRIO is " + String ((int64) limit.rlim_cur)
+                     + ", raise rtprio in /etc/security/limits.conf";
+        }
+       #endif
+
+        return name + " failed (error " + String (error) + ")";
+    }
+
+    static String describeAffinityError (int error, uint64 coreMask)
+    {
+        auto name = "cores 0x" + String::toHexString ((int64) coreMask);
+
+        if (error == Report::notApplied)
+            return "unpinned";
+
+        if (error == 0)
+            return name;
+
+        if (error == unsupported)
+            return name + " unsupported on this platform";
+
+        return name + " failed (error " + String (error) + ")";
+    }
+
+private:
+    static constexpr int unsupported = -2;
+
+    static std::atomic<uint64>& getRealtimeCoreMask() noexcept
+    {
+        static std::atomic<uint64> mask { 0 };
+        return mask;
+    }
+
+    static std::atomic<uint32>& getGeneration() noexcept
+    {
+        static std::atomic<uint32> generation { 0 };
+        return generation;
+    }
+};
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Created:    18 Oct 2026 1:31:08am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <type_traits>
+
+/// TripleBuffer passes the latest value of T from one writer thread to one
+/// reader thread without either of them ever waiting or allocating.
+///
+/// There are three copies: the writer fills its back copy and publishes it by
+/// swapping it with the middle one, and the reader swaps its front copy with
+/// the middle one whenever something new has been published. Both swaps are
+/// a single atomic exchange. Values published faster than the reader picks
+/// them up are simply skipped, so only the newest one is ever seen.
+template <typename T>
+class TripleBuffer
+{
+public:
+    static_assert (std::is_trivially_copyable_v<T>, "Copied on the audio thread, so mustn't allocate");
+
+    /// Writer: the copy to fill in before publish().
+    T& getBack() noexcept               { return values[backIndex]; }
+
+    /// Writer: hands the back copy over to the reader.
+    void publish() noexcept
+    {
+        backIndex = middle.exchange (backIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    /// Reader: moves to the newest published value, returning false if there was none.
+    bool update() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        frontIndex = middle.exchange (frontIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    /// Reader: the value as of the last update().
+    const T& getFront() const noexcept  { return values[frontIndex]; }
+
+private:
+    static constexpr int freshBit = 4, indexMask = 3;
+
+    T values[3] {};
+    std::atomic<int> middle { 1 };
+    int backIndex = 2, frontIndex = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
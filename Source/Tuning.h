@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    Tuning.h
+    Created:    18 Oct 2026 12:21:37am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>
+
+/// Tuning maps MIDI notes to frequencies: 12-TET with A4 = 440 Hz until a
+/// Scala scale (.scl), optionally with a keyboard mapping (.kbm), is loaded.
+/// Message thread; the audio thread only sees TuningTables built from it.
+class Tuning
+{
+public:
+    static constexpr int numNotes = 128;
+
+    Tuning()
+    {
+        for (int note = 0; note < numNotes; ++note)
+            frequencies[note] = 440.0 * std::pow (2.0, (note - 69) / 12.0);
+    }
+
+    /// 0 for a note the keyboard mapping leaves unmapped.
+    double getFrequency (int note) const noexcept   { return frequencies[note]; }
+    const String& getDescription() const noexcept   { return description; }
+
+    /// Returns false, leaving the tuning as it was, if either file can't be read or parsed.
+    bool loadScala (const File& scaleFile, const File& keyboardMappingFile = {})
+    {
+        if (! scaleFile.existsAsFile())
+            return false;
+
+        return loadScala (scaleFile.loadFileAsString(),
+                          keyboardMappingFile.existsAsFile() ? keyboardMappingFile.loadFileAsString() : String());
+    }
+
+    /// The text of a .scl file and, optionally, of a .kbm file. Without a
+    /// mapping, every key is the next scale degree, with degree 0 on middle C
+    /// and A4 at 440 Hz.
+    bool loadScala (const String& scaleText, const String& keyboardMappingText = {})
+    {
+        String newDescription;
+        Array<double> cents;
+        KeyboardMapping mapping;
+
+        if (! parseScale (scaleText, newDescription, cents))
+            return false;
+
+        if (keyboardMappingText.isNotEmpty() && ! parseKeyboardMapping (keyboardMappingText, mapping))
+            return false;
+
+        double newFrequencies[numNotes];
+        double referenceCents;
+
+        if (! getCents (mapping.referenceNote, cents, mapping, referenceCents))
+            return false;
+
+        for (int note = 0; note < numNotes; ++note)
+        {
+            double noteCents;
+            newFrequencies[note] = getCents (note, cents, mapping, noteCents)
+                                     ? mapping.referenceFrequency * std::pow (2.0, (noteCents - referenceCents) / 1200.0)
+                                     : 0.0;
+        }
+
+        std::copy (std::begin (newFrequencies), std::end (newFrequencies), std::begin (frequencies));
+        description = newDescription;
+        return true;
+    }
+
+private:
+    struct KeyboardMapping
+    {
+        int firstNote = 0, lastNote = numNotes - 1, middleNote = 60, referenceNote = 69;
+        double referenceFrequency = 440.0;
+        int octaveDegree = 0;       // 0: the scale's own period
+        Array<int> keys;            // scale degree per key of the pattern, -1 if unmapped; empty maps linearly
+    };
+
+    /// Lines of a Scala file without comments ('!') or surrounding whitespace.
+    static StringArray getScalaLines (const String& text)
+    {
+        StringArray lines;
+
+        for (auto& line : StringArray::fromLines (text))
+            if (! line.startsWithChar ('!'))
+                lines.add (line.trim());
+
+        return lines;
+    }
+
+    /// cents receives 0 for degree 0, then every degree in the file; the last is the period.
+    static bool parseScale (const String& text, String& descriptionOut, Array<double>& cents)
+    {
+        auto lines = getScalaLines (text);
+
+        if (lines.size() < 2)
+            return false;
+
+        descriptionOut = lines[0];
+        auto numDegrees = lines[1].getIntValue();
+
+        if (numDegrees < 1 || lines.size() < 2 + numDegrees)
+            return false;
+
+        cents.add (0.0);
+
+        for (int i = 0; i < numDegrees; ++i)
+        {
+            auto pitch = lines[2 + i].upToFirstOccurrenceOf (" ", false, false)
+                                     .upToFirstOccurrenceOf ("\t", false, false);
+
+            // A period means cents; anything else is a ratio, or a whole number
+            if (pitch.containsChar ('.'))
+            {
+                cents.add (pitch.getDoubleValue());
+                continue;
+            }
+
+            auto numerator = pitch.upToFirstOccurrenceOf ("/", false, false).getLargeIntValue();
+            auto denominator = pitch.containsChar ('/') ? pitch.fromFirstOccurrenceOf ("/", false, false).getLargeIntValue() : 1;
+
+            if (numerator <= 0 || denominator <= 0)
+                return false;
+
+            cents.add (1200.0 * std::log2 ((double) numerator / (double) denominator));
+        }
+
+        return cents.getLast() > 0.0;
+    }
+
+    static bool parseKeyboardMapping (const String& text, KeyboardMapping& mapping)
+    {
+        auto lines = getScalaLines (text);
+
+        if (lines.size() < 7)
+            return false;
+
+        auto size = lines[0].getIntValue();
+        mapping.firstNote = jlimit (0, numNotes - 1, lines[1].getIntValue());
+        mapping.lastNote = jlimit (0, numNotes - 1, lines[2].getIntValue());
+        mapping.middleNote = lines[3].getIntValue();
+        mapping.referenceNote = jlimit (0, numNotes - 1, lines[4].getIntValue());
+        mapping.referenceFrequency = lines[5].getDoubleValue();
+        mapping.octaveDegree = lines[6].getIntValue();
+
+        if (size < 0 || mapping.referenceFrequency <= 0.0 || lines.size() < 7 + size)
+            return false;
+
+        for (int i = 0; i < size; ++i)
+            mapping.keys.add (lines[7 + i].startsWithChar ('x') ? -1 : lines[7 + i].getIntValue());
+
+        return true;
+    }
+
+    /// The pitch of `note` in cents above degree 0 of the middle note's period;
+    /// false if the note is unmapped.
+    static bool getCents (int note, const Array<double>& cents, const KeyboardMapping& mapping, double& result)
+    {
+        if (note < mapping.firstNote || note > mapping.lastNote)
+            return false;
+
+        auto numDegrees = cents.size() - 1;
+        auto offset = note - mapping.middleNote;
+        int degree;
+
+        if (mapping.keys.isEmpty())
+        {
+            degree = offset;
+        }
+        else
+        {
+            auto patternSize = mapping.keys.size();
+            auto key = mapping.keys[((offset % patternSize) + patternSize) % patternSize];
+
+            if (key < 0)
+                return false;
+
+            auto octaveDegree = mapping.octaveDegree > 0 ? mapping.octaveDegree : numDegrees;
+            degree = key + (int) std::floor ((double) offset / patternSize) * octaveDegree;
+        }
+
+        auto period = (int) std::floor ((double) degree / numDegrees);
+        result = period * cents.getLast() + cents[degree - period * numDegrees];
+        return true;
+    }
+
+    double frequencies[numNotes];
+    String description { "12-TET" };
+};
+
+/// TuningTable is a Tuning evaluated at one sample rate: each note's phase
+/// increment, so a note-on is a single lookup, and its pitch as a fractional
+/// 12-TET MIDI note number, which glides and bends work in.
+struct TuningTable
+{
+    void build (const Tuning& tuning, double sampleRate) noexcept
+    {
+        for (int note = 0; note < Tuning::numNotes; ++note)
+        {
+            auto frequency = tuning.getFrequency (note);
+            increments[note] = MathConstants<double>::twoPi * frequency / sampleRate;
+            pitches[note] = frequency > 0.0 ? (float) (69.0 + 12.0 * std::log2 (frequency / 440.0)) : 0.0f;
+        }
+    }
+
+    double increments[Tuning::numNotes] {};    // radians per sample; 0 for unmapped notes
+    float pitches[Tuning::numNotes] {};
+};
@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    VectorMorph.h
+    Created:    18 Oct 2026 3:37:44am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>
+#include "Modulation.h"
+#include "WavetableStore.h"
+
+/// VectorMorph reads a point (x, y) inside a square whose corners are four
+/// waves of a set, in the manner of vector synthesis: the four corner tables
+/// are read at the same phase and blended with bilinear weights
+///     (1 - x)(1 - y), x(1 - y), (1 - x)y, xy
+/// so x = morph and y = 0 is a plain crossfade between the bottom two corners.
+///
+/// The four corner samples sit in one SIMD register (one lane each), as do
+/// the weights, so the blend is a single multiply and horizontal sum per
+/// sample: barely more than the two-wave crossfade it replaces.
+struct VectorMorph
+{
+    using Vector = dsp::SIMDRegister<float>;
+    static constexpr int lanes = (int) Vector::SIMDNumElements;
+    static_assert (lanes >= 4, "One lane per corner");
+
+    /// The corner tables of the mip a set uses for a given increment.
+    struct Reader
+    {
+        Reader (const WavetableSet& set, const VectorParameters& parameters, double highestIncrement) noexcept
+            : tableMask (set.getTableSize() - 1),
+              tableScale ((float) set.getTableSize())
+        {
+            auto mip = set.findResidentMip (set.getMipForIncrement (highestIncrement / MathConstants<double>::twoPi));
+
+            // A sparse set whose levels haven't been decoded yet is read as silence
+            if (mip < 0)
+                return;
+
+            // One load for all four corners, so the decoder can't detach the
+            // level between them and leave some corners pointing nowhere
+            auto* waves = set.getTable (0, mip);
+
+            if (waves == nullptr)
+                return;
+
+            auto lastWave = set.getNumWaves() - 1;
+            auto stride = WavetableSet::getStrideFor (set.getTableSize());
+
+            for (int corner = 0; corner < 4; ++corner)
+                tables[corner] = waves + stride * (size_t) roundToInt (jlimit (0.0, 1.0, parameters.corners[corner]) * lastWave);
+        }
+
+        bool isSilent() const noexcept
+        {
+            return tables[0] == nullptr || tables[1] == nullptr || tables[2] == nullptr || tables[3] == nullptr;
+        }
+
+        /// The blend at `cycles` (any range) with the corner weights in lanes 0..3.
+        float read (Vector weights, float cycles) const noexcept
+        {
+            alignas (sizeof (Vector)) float here[lanes] {}, next[lanes] {};
+
+            auto tablePosition = cycles * tableScale;
+            auto whole = std::floor (tablePosition);
+            auto index = static_cast<int> (whole) & tableMask;
+
+            for (int corner = 0; corner < 4; ++corner)
+            {
+                here[corner] = tables[corner][index];
+                next[corner] = tables[corner][index + 1];
+            }
+
+            auto a = Vector::fromRawArray (here);
+            auto samples = a + (Vector::fromRawArray (next) - a) * (tablePosition - whole);
+            return (samples * weights).sum();
+        }
+
+        const int tableMask;
+        const float tableScale;
+        const float* tables[4] {};
+    };
+
+    /// The bilinear weights of (x, y), one corner per lane.
+    static Vector getWeights (double x, double y) noexcept
+    {
+        alignas (sizeof (Vector)) float weights[lanes] {};
+        weights[0] = (float) ((1.0 - x) * (1.0 - y));
+        weights[1] = (float) (x * (1.0 - y));
+        weights[2] = (float) ((1.0 - x) * y);
+        weights[3] = (float) (x * y);
+        return Vector::fromRawArray (weights);
+    }
+
+    /// Reads numSamples into dest at the phases (in cycles) in `cycles`, with x
+    /// and y ramping by xStep and yStep per sample.
+    static void render (const WavetableSet& set, const VectorParameters& parameters, float* dest, const float* cycles,
+                        int numSamples, double highestIncrement, double x, double xStep, double y, double yStep) noexcept
+    {
+        const Reader reader (set, parameters, highestIncrement);
+
+        if (reader.isSilent())
+        {
+            // The phase keeps running regardless
+            FloatVectorOperations::clear (dest, numSamples);
+            return;
+        }
+
+        // Each weight is an x factor times a y factor, and each factor ramps linearly
+        alignas (sizeof (Vector)) float xFactors[lanes] {}, yFactors[lanes] {}, xSteps[lanes] {}, ySteps[lanes] {};
+        xFactors[0] = xFactors[2] = (float) (1.0 - x);
+        xFactors[1] = xFactors[3] = (float) x;
+        yFactors[0] = yFactors[1] = (float) (1.0 - y);
+        yFactors[2] = yFactors[3] = (float) y;
+        xSteps[0] = xSteps[2] = (float) -xStep;
+        xSteps[1] = xSteps[3] = (float) xStep;
+        ySteps[0] = ySteps[1] = (float) -yStep;
+        ySteps[2] = ySteps[3] = (float) yStep;
+
+        auto xFactor = Vector::fromRawArray (xFactors), yFactor = Vector::fromRawArray (yFactors);
+        const auto xRamp = Vector::fromRawArray (xSteps), yRamp = Vector::fromRawArray (ySteps);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            dest[i] = reader.read (xFactor * yFactor, cycles[i]);
+            xFactor += xRamp;
+            yFactor += yRamp;
+        }
+    }
+};
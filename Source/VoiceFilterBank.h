@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    VoiceFilterBank.h
+    Created:    17 Oct 2026 10:41:52pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>
+#include "Modulation.h"
+#include "RealtimeArena.h"
+
+/// VoiceFilterBank is one resonant state-variable filter per voice (the
+/// topology-preserving transform design, as in dsp::StateVariableTPTFilter),
+/// processed across voices rather than one voice at a time.
+///
+/// Voices are grouped `lanes` at a time (4 with SSE or NEON, 8 with AVX). State
+/// and coefficients are structure-of-arrays, indexed by voice, so a group
+/// loads straight into SIMD registers and every filter operation runs on the
+/// whole group at once. Coefficients cost a tan() each, so they are only
+/// recomputed for a voice whose cutoff, resonance or response has changed.
+class VoiceFilterBank
+{
+public:
+    using Vector = dsp::SIMDRegister<float>;
+    static constexpr int lanes = (int) Vector::SIMDNumElements;
+
+    /// Takes state, coefficients and scratch space from `arena` (which may be a dry run).
+    void prepare (RealtimeArena& arena, int maxVoicesToUse, int maximumBlockSize, double sampleRateToUse)
+    {
+        maxVoices = maxVoicesToUse;
+        sampleRate = sampleRateToUse;
+        numGroups = (maxVoices + lanes - 1) / lanes;
+
+        auto rowLength = (size_t) jmax (1, numGroups * lanes);
+
+        for (auto* row : { &ic1eq, &ic2eq, &a1, &a2, &a3, &m0, &m1, &m2, &lastCutoff, &lastResonance })
+            *row = arena.allocate<float> (rowLength);
+
+        lastResponse = arena.allocate<FilterParameters::Response> (rowLength);
+        interleaved = arena.allocate<float> ((size_t) jmax (1, maximumBlockSize) * lanes);
+
+        if (ic1eq != nullptr)
+            for (int voice = 0; voice < numGroups * lanes; ++voice)
+                forgetVoice (voice);
+    }
+
+    int getNumGroups() const noexcept   { return numGroups; }
+
+    /// Control rate: sets a voice's filter, recomputing its coefficients only if something changed.
+    void setVoice (int voice, FilterParameters::Response response, float cutoffHz, float resonance) noexcept
+    {
+        jassert (isPositiveAndBelow (voice, maxVoices));
+
+        cutoffHz = jlimit (10.0f, (float) (0.49 * sampleRate), cutoffHz);
+        resonance = jlimit (0.0f, 1.0f, resonance);
+
+        if (cutoffHz == lastCutoff[voice] && resonance == lastResonance[voice] && response == lastResponse[voice])
+            return;
+
+        lastCutoff[voice] = cutoffHz;
+        lastResonance[voice] = resonance;
+        lastResponse[voice] = response;
+
+        auto g = (float) std::tan (MathConstants<double>::pi * cutoffHz / sampleRate);
+        auto k = 2.0f - 1.96f * resonance;
+
+        a1[voice] = 1.0f / (1.0f + g * (g + k));
+        a2[voice] = g * a1[voice];
+        a3[voice] = g * a2[voice];
+
+        // output = m0 * input + m1 * band + m2 * low
+        switch (response)
+        {
+            case FilterParameters::Response::lowpass:   m0[voice] = 0.0f; m1[voice] = 0.0f; m2[voice] = 1.0f;  break;
+            case FilterParameters::Response::bandpass:  m0[voice] = 0.0f; m1[voice] = 1.0f; m2[voice] = 0.0f;  break;
+            case FilterParameters::Response::highpass:  m0[voice] = 1.0f; m1[voice] = -k;   m2[voice] = -1.0f; break;
+        }
+    }
+
+    /// Clears a voice's state and forces its coefficients to be recomputed at the next setVoice().
+    void forgetVoice (int voice) noexcept
+    {
+        ic1eq[voice] = ic2eq[voice] = 0.0f;
+        a1[voice] = a2[voice] = a3[voice] = m0[voice] = m1[voice] = m2[voice] = 0.0f;
+        lastCutoff[voice] = lastResonance[voice] = -1.0f;
+    }
+
+    /// Filters numSamples of one group in place. channels[lane] is the mono
+    /// signal of voice group * lanes + lane, or nullptr for a silent voice.
+    void processGroup (int group, float* const* channels, int numSamples) noexcept
+    {
+        jassert (isPositiveAndBelow (group, numGroups));
+
+        // Transpose into lane order, so each sample of the group is one register
+        for (int lane = 0; lane < lanes; ++lane)
+            for (int i = 0; i < numSamples; ++i)
+                interleaved[i * lanes + lane] = channels[lane] != nullptr ? channels[lane][i] : 0.0f;
+
+        auto offset = group * lanes;
+        auto s1 = Vector::fromRawArray (ic1eq + offset), s2 = Vector::fromRawArray (ic2eq + offset);
+        const auto c1 = Vector::fromRawArray (a1 + offset), c2 = Vector::fromRawArray (a2 + offset), c3 = Vector::fromRawArray (a3 + offset);
+        const auto mixInput = Vector::fromRawArray (m0 + offset), mixBand = Vector::fromRawArray (m1 + offset), mixLow = Vector::fromRawArray (m2 + offset);
+        const auto two = Vector::expand (2.0f);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto* frame = interleaved + i * lanes;
+            auto input = Vector::fromRawArray (frame);
+
+            auto v3 = input - s2;
+            auto band = c1 * s1 + c2 * v3;
+            auto low = s2 + c2 * s1 + c3 * v3;
+            s1 = two * band - s1;
+            s2 = two * low - s2;
+
+            (mixInput * input + mixBand * band + mixLow * low).copyToRawArray (frame);
+        }
+
+        s1.copyToRawArray (ic1eq + offset);
+        s2.copyToRawArray (ic2eq + offset);
+
+        for (int lane = 0; lane < lanes; ++lane)
+            if (channels[lane] != nullptr)
+                for (int i = 0; i < numSamples; ++i)
+                    channels[lane][i] = interleaved[i * lanes + lane];
+    }
+
+private:
+    int maxVoices = 0, numGroups = 0;
+    double sampleRate = 44100.0;
+
+    float* ic1eq = nullptr;
+    float* ic2eq = nullptr;
+    float* a1 = nullptr;
+    float* a2 = nullptr;
+    float* a3 = nullptr;
+    float* m0 = nullptr;
+    float* m1 = nullptr;
+    float* m2 = nullptr;
+    float* lastCutoff = nullptr;
+    float* lastResonance = nullptr;
+    FilterParameters::Response* lastResponse = nullptr;
+    float* interleaved = nullptr;
+};
@@ -0,0 +1,303 @@
+/*
+  ==============================================================================
+
+    WavetableCache.h
+    Created:    17 Oct 2026 4:47:30pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <deque>
+#include <list>
+#include <map>
+#include <vector>
+#include "ThreadTuning.h"
+#include "WavetableImporter.h"
+
+/// WavetableCache loads file-based wavetables on a dedicated I/O thread and
+/// keeps the prepared sets in a bounded LRU, so browsing presets never
+/// stalls the message thread on disk or FFT work. Results are handed back on
+/// the message thread, fully built and interned in the WavetableStore, ready
+/// for SynthAudioSource::loadWavetables; the audio path never sees a table
+/// that is still being prepared.
+///
+/// select() loads one file from a list (e.g. the presets in a folder) and
+/// quietly prefetches its neighbours, which is what makes stepping through
+/// the list feel instant.
+class WavetableCache final : private Thread,
+                             private AsyncUpdater
+{
+public:
+    using Callback = std::function<void (WavetableSet::Ptr)>;
+    using LoadFunction = std::function<WavetableSet::Ptr (const File&)>;
+
+    struct Metrics
+    {
+        int hits = 0, misses = 0, prefetchHits = 0, loads = 0, failures = 0, evictions = 0;
+        double averageLoadMs = 0.0, worstLoadMs = 0.0;
+        size_t residentBytes = 0;
+        int residentSets = 0;
+    };
+
+    /// budgetBytes bounds the table data kept alive by the cache itself.
+    /// loadFunction turns a file into an unsealed or sealed set; the default
+    /// builds single- or multi-cycle audio files with WavetableImporter::build,
+    /// pass a WavetableImporter's import() instead to use its disk cache.
+    WavetableCache (WavetableStore& storeToUse, size_t budgetBytesToUse = 256 * 1024 * 1024,
+                    LoadFunction loadFunctionToUse = {})
+        : Thread ("Wavetable loader"),
+          store (storeToUse),
+          budgetBytes (budgetBytesToUse),
+          loadFunction (std::move (loadFunctionToUse))
+    {
+        if (! loadFunction)
+            loadFunction = [] (const File& file) { return WavetableImporter::build (file); };
+
+        startThread (Priority::low);
+    }
+
+    ~WavetableCache() override
+    {
+        stopThread (4000);
+        cancelPendingUpdate();
+    }
+
+    /// Message thread: calls onReady with the prepared set, immediately on a
+    /// hit, or from a later message-thread callback once it has been loaded.
+    /// onReady receives nullptr if the file couldn't be loaded.
+    void request (const File& file, Callback onReady)
+    {
+        JUCE_ASSERT_MESSAGE_THREAD
+
+        auto key = file.getFullPathName();
+        const ScopedLock sl (lock);
+        auto cached = entries.find (key);
+
+        if (cached != entries.end())
+        {
+            ++metrics.hits;
+            metrics.prefetchHits += cached->second->prefetched ? 1 : 0;
+            cached->second->prefetched = false;
+            lru.splice (lru.begin(), lru, cached->second);
+            auto set = cached->second->set;
+
+            ScopedUnlock ul (lock);
+            onReady (set);
+            return;
+        }
+
+        ++metrics.misses;
+
+        // Still under the lock, so a load finishing in between can't be queued twice
+        enqueue (file, std::move (onReady), true);
+    }
+
+    /// Message thread: loads files[index] and prefetches up to `radius` files on either side.
+    void select (const Array<File>& files, int index, int radius, Callback onReady)
+    {
+        if (! isPositiveAndBelow (index, files.size()))
+            return;
+
+        request (files.getReference (index), std::move (onReady));
+
+        for (int distance = 1; distance <= radius; ++distance)
+            for (auto neighbour : { index + distance, index - distance })
+                if (isPositiveAndBelow (neighbour, files.size()))
+                    prefetch (files.getReference (neighbour));
+    }
+
+    /// Any thread: loads a file into the cache in the background without a callback.
+    void prefetch (const File& file)
+    {
+        const ScopedLock sl (lock);
+
+        if (entries.find (file.getFullPathName()) == entries.end())
+            enqueue (file, {}, false);
+    }
+
+    Metrics getMetrics() const
+    {
+        const ScopedLock sl (lock);
+        auto result = metrics;
+        result.residentBytes = residentBytes;
+        result.residentSets = (int) lru.size();
+        return result;
+    }
+
+private:
+    struct Entry
+    {
+        String key;
+        WavetableSet::Ptr set;
+        bool prefetched = false;
+    };
+
+    struct Job
+    {
+        File file;
+        std::vector<Callback> callbacks;
+        double requestedAtMs = 0.0;
+        bool wanted = false;    // someone is waiting, as opposed to a prefetch
+    };
+
+    struct Completed
+    {
+        std::vector<Callback> callbacks;
+        WavetableSet::Ptr set;
+    };
+
+    /// Call with `lock` held, in the same critical section as the lookup that
+    /// found the file missing.
+    void enqueue (const File& file, Callback onReady, bool wanted)
+    {
+        // Merge with a queued or in-flight load of the same file
+        for (auto& job : queue)
+        {
+            if (job.file == file)
+            {
+                if (onReady)
+                    job.callbacks.push_back (std::move (onReady));
+
+                job.wanted = job.wanted || wanted;
+                return;
+            }
+        }
+
+        if (inFlight != nullptr && inFlight->file == file)
+        {
+            if (onReady)
+                inFlight->callbacks.push_back (std::move (onReady));
+
+            inFlight->wanted = inFlight->wanted || wanted;
+            return;
+        }
+
+        Job job { file, {}, Time::getMillisecondCounterHiRes(), wanted };
+        if (onReady)
+            job.callbacks.push_back (std::move (onReady));
+
+        // Wanted loads jump ahead of prefetches
+        if (wanted)
+            queue.push_front (std::move (job));
+        else
+            queue.push_back (std::move (job));
+
+        notify();
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            ThreadTuning::keepOffRealtimeCores();
+
+            Job job;
+            {
+                const ScopedLock sl (lock);
+
+                if (queue.empty())
+                {
+                    ScopedUnlock ul (lock);
+                    wait (-1);
+                    continue;
+                }
+
+                job = std::move (queue.front());
+                queue.pop_front();
+                inFlight = &job;
+            }
+
+            auto set = loadFunction (job.file);
+
+            if (set != nullptr)
+                set = store.intern (set);
+
+            auto elapsedMs = Time::getMillisecondCounterHiRes() - job.requestedAtMs;
+
+            const ScopedLock sl (lock);
+            inFlight = nullptr;
+
+            if (set == nullptr)
+            {
+                ++metrics.failures;
+            }
+            else
+            {
+                ++metrics.loads;
+                metrics.averageLoadMs += (elapsedMs - metrics.averageLoadMs) / metrics.loads;
+                metrics.worstLoadMs = jmax (metrics.worstLoadMs, elapsedMs);
+                insert (job.file.getFullPathName(), set, ! job.wanted);
+            }
+
+            if (! job.callbacks.empty())
+            {
+                completed.push_back ({ std::move (job.callbacks), set });
+                triggerAsyncUpdate();
+            }
+        }
+    }
+
+    /// Adds or replaces the entry for `key` as the most recently used one. Call with `lock` held.
+    void insert (const String& key, WavetableSet::Ptr set, bool prefetched)
+    {
+        auto existing = entries.find (key);
+
+        if (existing != entries.end())
+        {
+            auto& entry = *existing->second;
+            residentBytes -= entry.set->getNumBytes();
+            entry.set = set;
+            entry.prefetched = prefetched;
+            lru.splice (lru.begin(), lru, existing->second);
+        }
+        else
+        {
+            lru.push_front ({ key, set, prefetched });
+            entries[key] = lru.begin();
+        }
+
+        residentBytes += set->getNumBytes();
+
+        // Evict from the cold end, but always keep the newest entry
+        while (residentBytes > budgetBytes && lru.size() > 1)
+        {
+            auto& victim = lru.back();
+            residentBytes -= victim.set->getNumBytes();
+            entries.erase (victim.key);
+            lru.pop_back();
+            ++metrics.evictions;
+        }
+    }
+
+    void handleAsyncUpdate() override
+    {
+        std::vector<Completed> ready;
+        {
+            const ScopedLock sl (lock);
+            ready.swap (completed);
+        }
+
+        for (auto& result : ready)
+            for (auto& callback : result.callbacks)
+                callback (result.set);
+
+        // Sets evicted above may now be unreferenced
+        store.purgeUnused();
+    }
+
+    WavetableStore& store;
+    const size_t budgetBytes;
+    LoadFunction loadFunction;
+
+    CriticalSection lock;
+    std::list<Entry> lru;
+    std::map<String, std::list<Entry>::iterator> entries;
+    size_t residentBytes = 0;
+    std::deque<Job> queue;
+    Job* inFlight = nullptr;
+    std::vector<Completed> completed;
+    Metrics metrics;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavetableCache)
+};
@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    WavetableImporter.h
+    Created:    17 Oct 2026 5:21:44pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <memory>
+#include <vector>
+#include "WavetableStore.h"
+
+/// WavetableImporter turns single-cycle and multi-frame audio files into
+/// WavetableSets and keeps the result in a versioned binary cache on disk.
+///
+/// The first import of a file decodes it with juce_audio_formats, slices it
+/// into frames and band-limits every frame on a ThreadPool. The finished
+/// tables (guard samples included) are then written to the cache, exactly in
+/// the WavetableSet memory layout, followed by the set's partials and shape
+/// fits, so later imports of the same file just map the cache file and view it
+/// in place: no decoding, no FFTs, and only the small analysis copied.
+///
+/// A cache file is only used if its format version, table size and the source
+/// file's size and modification time all match; otherwise the file is rebuilt.
+/// import() blocks, so call it from a background thread, e.g. as the
+/// WavetableCache load function (whose metrics then show the load times).
+class WavetableImporter
+{
+public:
+    /// Bump whenever the builder's output or the file layout changes.
+    static constexpr uint32 cacheVersion = 2;
+
+    explicit WavetableImporter (const File& cacheDirectoryToUse = getDefaultCacheDirectory(),
+                                int tableSizeToUse = WavetableSet::defaultTableSize)
+        : cacheDirectory (cacheDirectoryToUse),
+          tableSize (tableSizeToUse),
+          pool (ThreadPoolOptions().withThreadName ("Wavetable mipmapper")
+                                   .withNumberOfThreads (jmax (1, SystemStats::getNumCpus() - 1))
+                                   .withDesiredThreadPriority (Thread::Priority::low))
+    {
+    }
+
+    /// Returns the set for `file`, from the disk cache if it is up to date,
+    /// otherwise built from scratch and written to the cache. Returns nullptr
+    /// if the file isn't a readable audio file.
+    WavetableSet::Ptr import (const File& file)
+    {
+        auto cacheFile = getCacheFileFor (file);
+        auto set = loadCacheFile (cacheFile, file);
+
+        if (set != nullptr)
+            return set;
+
+        set = build (file, &pool, tableSize);
+
+        if (set == nullptr)
+            return nullptr;
+
+        set->seal();
+
+        if (! writeCacheFile (cacheFile, file, *set))
+            DBG ("Couldn't write wavetable cache file " << cacheFile.getFullPathName());
+
+        return set;
+    }
+
+    /// Decodes and band-limits a file without touching the cache: the first
+    /// channel, cut into tableSize-sample frames when its length allows,
+    /// otherwise treated as one cycle of arbitrary length.
+    static WavetableSet::Ptr build (const File& file, ThreadPool* pool = nullptr,
+                                    int tableSize = WavetableSet::defaultTableSize)
+    {
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+        if (reader == nullptr || reader->lengthInSamples < 2)
+            return nullptr;
+
+        auto length = (int) jmin (reader->lengthInSamples, (int64) (1 << 22));
+        AudioBuffer<float> audio (1, length);
+        reader->read (&audio, 0, length, 0, true, false);
+
+        auto isMultiFrame = length >= tableSize && length % tableSize == 0;
+        auto cycleLength = isMultiFrame ? tableSize : length;
+        auto numCycles = jmin (isMultiFrame ? length / tableSize : 1, maxFrames);
+
+        std::vector<const float*> cycles;
+        for (int i = 0; i < numCycles; ++i)
+            cycles.push_back (audio.getReadPointer (0, i * cycleLength));
+
+        return WavetableBuilder::createFromCycles (cycles.data(), numCycles, cycleLength, tableSize, pool);
+    }
+
+    File getCacheFileFor (const File& source) const
+    {
+        return cacheDirectory.getChildFile (String::toHexString (source.getFullPathName().hashCode64()) + ".mwt");
+    }
+
+    static File getDefaultCacheDirectory()
+    {
+        return File::getSpecialLocation (File::userApplicationDataDirectory)
+                   .getChildFile ("MorphingOscillatorDemo")
+                   .getChildFile ("WavetableCache");
+    }
+
+private:
+    static constexpr int maxFrames = 256;
+
+    /// Precedes the table data; 64 bytes so the tables stay cache-line aligned.
+    struct CacheHeader
+    {
+        int64 sourceSize, sourceModified;
+        uint64 contentHash;
+        char magic[4];
+        uint32 version, byteOrderMark;
+        int32 numWaves, tableSize;
+        uint8 reserved[20];
+    };
+
+    static_assert (sizeof (CacheHeader) == RealtimeArena::cacheLineSize, "The table data must start on a cache line");
+
+    CacheHeader makeHeader (const File& source, int numWaves, uint64 contentHash) const
+    {
+        CacheHeader header {};
+        std::memcpy (header.magic, "MWTB", 4);
+        header.version = cacheVersion;
+        header.byteOrderMark = 0x01020304;
+        header.numWaves = numWaves;
+        header.tableSize = tableSize;
+        header.sourceSize = source.getSize();
+        header.sourceModified = source.getLastModificationTime().toMilliseconds();
+        header.contentHash = contentHash;
+        return header;
+    }
+
+    WavetableSet::Ptr loadCacheFile (const File& cacheFile, const File& source) const
+    {
+        if (! cacheFile.existsAsFile())
+            return nullptr;
+
+        CacheHeader header {};
+        {
+            FileInputStream in (cacheFile);
+
+            if (! in.openedOk() || in.read (&header, (int) sizeof (header)) != (int) sizeof (header))
+                return nullptr;
+        }
+
+        auto expected = makeHeader (source, header.numWaves, header.contentHash);
+
+        if (std::memcmp (&header, &expected, sizeof (header)) != 0
+             || ! isPositiveAndNotGreaterThan (header.numWaves, maxFrames)
+             || header.numWaves == 0)
+            return nullptr;
+
+        auto dataFloats = WavetableSet::getRequiredFloats (header.numWaves, tableSize);
+        auto partialFloats = (size_t) header.numWaves * 2 * WavetableSet::maxPartials;
+
+        if (cacheFile.getSize() != (int64) (sizeof (header) + (dataFloats + partialFloats) * sizeof (float)
+                                              + (size_t) header.numWaves * sizeof (WaveShapeFit)))
+            return nullptr;
+
+        auto memory = TableMemory::createMapped (cacheFile, sizeof (header));
+
+        if (memory == nullptr)
+            return nullptr;
+
+        // The analysis follows the tables: partials, then shape fits
+        auto* savedPartials = memory->getData() + dataFloats;
+        auto* savedShapes = reinterpret_cast<const WaveShapeFit*> (savedPartials + partialFloats);
+
+        WavetableSet::Ptr set = new WavetableSet (header.numWaves, tableSize, memory, 0);
+        set->sealWithHash (header.contentHash, savedPartials, savedShapes);
+        return set;
+    }
+
+    bool writeCacheFile (const File& cacheFile, const File& source, const WavetableSet& set) const
+    {
+        if (cacheDirectory.createDirectory().failed())
+            return false;
+
+        // Written beside the target and renamed over it, so a set still mapping
+        // the old file keeps its data and nobody ever maps a half-written one
+        TemporaryFile temp (cacheFile);
+        {
+            FileOutputStream out (temp.getFile());
+
+            if (out.failedToOpen())
+                return false;
+
+            auto header = makeHeader (source, set.getNumWaves(), set.getContentHash());
+
+            if (! out.write (&header, sizeof (header)) || ! out.write (set.getTable (0, 0), set.getNumBytes())
+                 || ! out.write (set.getPartials (0), set.getNumPartialFloats() * sizeof (float)))
+                return false;
+
+            for (int wave = 0; wave < set.getNumWaves(); ++wave)
+            {
+                auto shape = set.getShape (wave);
+
+                if (! out.write (&shape, sizeof (shape)))
+                    return false;
+            }
+
+            out.flush();
+
+            if (out.getStatus().failed())
+                return false;
+        }
+
+        return temp.overwriteTargetFileWithTemporary();
+    }
+
+    const File cacheDirectory;
+    const int tableSize;
+    ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavetableImporter)
+};
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    WavetableLibrary.h
+    Created:    17 Oct 2026 1:58:40pm
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "WavetableStore.h"
+
+/// WavetableLibrary keeps many multi-frame, multi-mip wavetables in a single
+/// TableMemory block, so that on Linux the whole library can sit on a few
+/// hundred 2 MB pages instead of hundreds of thousands of 4 KB ones.
+///
+/// Each entry is an ordinary WavetableSet viewing its slice of the block;
+/// fill it with WavetableBuilder, then hand it to
+/// SynthAudioSource::loadWavetables like any other set. The block stays alive
+/// as long as any entry does.
+class WavetableLibrary
+{
+public:
+    WavetableLibrary (int numEntries, int framesPerEntry,
+                      int tableSize = WavetableSet::defaultTableSize,
+                      TableMemory::Backing backing = TableMemory::Backing::transparentHugePages)
+        : entryFloats (WavetableSet::getRequiredFloats (framesPerEntry, tableSize)),
+          memory (new TableMemory (entryFloats * (size_t) numEntries, backing))
+    {
+        entries.ensureStorageAllocated (numEntries);
+
+        for (int i = 0; i < numEntries; ++i)
+            entries.add (new WavetableSet (framesPerEntry, tableSize, memory, entryFloats * (size_t) i));
+    }
+
+    int getNumEntries() const noexcept                      { return entries.size(); }
+    WavetableSet::Ptr getEntry (int index) const noexcept   { return entries[index]; }
+    WavetableSet& getEntryUnchecked (int index) const noexcept { return *entries.getUnchecked (index); }
+
+    TableMemory::Backing getBacking() const noexcept        { return memory->getBacking(); }
+    size_t getNumBytes() const noexcept                     { return memory->getNumBytes(); }
+
+private:
+    const size_t entryFloats;
+    TableMemory::Ptr memory;
+    ReferenceCountedArray<WavetableSet> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavetableLibrary)
+};
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    WavetablePublisher.h
+    Created:    17 Oct 2026 11:48:51am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <vector>
+#include "ThreadTuning.h"
+#include "WavetableStore.h"
+
+/// WavetablePublisher hands the active WavetableSet from the message thread
+/// to the audio thread, RCU style.
+///
+/// The active set is published through an atomic pointer. The audio thread
+/// only ever loads that pointer and bumps the reference count of sets it
+/// keeps (incReferenceCount / decReferenceCountWithoutDeleting), so it never
+/// frees anything. Replaced sets are parked on a retire list until the audio
+/// thread has passed a block boundary, after which no block can still be
+/// about to pick them up. A background thread then drops them and purges the
+/// store, which is where the memory of sets no voice references is finally
+/// released.
+class WavetablePublisher final : private Thread
+{
+public:
+    WavetablePublisher (WavetableStore& storeToUse, WavetableSet::Ptr initialSet)
+        : Thread ("Wavetable reclaimer"),
+          store (storeToUse),
+          current (store.intern (std::move (initialSet)))
+    {
+        active.store (current.get(), std::memory_order_release);
+        startThread (Priority::background);
+    }
+
+    ~WavetablePublisher() override
+    {
+        stopThread (2000);
+    }
+
+    /// Makes newSet the active set. Voices pick it up at their next block and
+    /// crossfade to it (or once a crossfade they are in has finished).
+    /// Message thread only.
+    void publish (WavetableSet::Ptr newSet)
+    {
+        newSet = store.intern (std::move (newSet));
+
+        if (newSet == current)
+            return;
+
+        auto replaced = current;
+        current = newSet;
+        active.store (current.get());
+
+        // Stamped only after the swap: a block that started before this epoch
+        // may still have loaded the old pointer, one that starts after can't
+        {
+            const ScopedLock sl (retireLock);
+            retired.push_back ({ std::move (replaced), epoch.load() });
+        }
+
+        notify();
+    }
+
+    /// The currently published set. Safe to call on the audio thread; the
+    /// pointer stays valid at least until the next markBlockBoundary(), so
+    /// callers that keep it longer must incReferenceCount() before then.
+    WavetableSet* getActive() const noexcept    { return active.load (std::memory_order_acquire); }
+
+    /// Audio thread: call once after every rendered block.
+    void markBlockBoundary() noexcept           { epoch.fetch_add (1, std::memory_order_acq_rel); }
+
+    /// Call with false while no audio callback runs (before the device starts,
+    /// and from releaseResources, which also covers a suspended device) and with
+    /// true before it starts again. While no reader runs nothing marks block boundaries, so the
+    /// reclaimer advances the epoch itself and retired sets are still freed.
+    void setReaderActive (bool shouldBeActive)
+    {
+        {
+            const ScopedLock sl (retireLock);
+            readerActive = shouldBeActive;
+        }
+
+        if (! shouldBeActive)
+            notify();
+    }
+
+    /// Block boundaries seen so far. Memory a reader could have picked up before
+    /// some epoch E is safe to reuse once getEpoch() > E.
+    uint64 getEpoch() const noexcept            { return epoch.load (std::memory_order_acquire); }
+
+    /// Message thread: the set voices are crossfading towards.
+    WavetableSet::Ptr getCurrent() const        { return current; }
+
+private:
+    struct RetiredSet
+    {
+        WavetableSet::Ptr set;
+        uint64 retiredAtEpoch;
+    };
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (250);
+            ThreadTuning::keepOffRealtimeCores();
+            reclaim();
+        }
+    }
+
+    void reclaim()
+    {
+        {
+            const ScopedLock sl (retireLock);
+
+            // Under the lock, so a reader that becomes active can't start a
+            // block between this check and the erase below
+            if (! readerActive)
+                markBlockBoundary();
+
+            auto now = epoch.load (std::memory_order_acquire);
+
+            retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                           [now] (const RetiredSet& r) { return now > r.retiredAtEpoch; }),
+                           retired.end());
+        }
+
+        // Voices still crossfading hold their own references, so only sets
+        // nobody touches any more are freed here
+        store.purgeUnused();
+    }
+
+    WavetableStore& store;
+    WavetableSet::Ptr current;
+    std::atomic<WavetableSet*> active { nullptr };
+    std::atomic<uint64> epoch { 0 };
+
+    CriticalSection retireLock;
+    std::vector<RetiredSet> retired;
+    bool readerActive = true;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavetablePublisher)
+};
@@ -0,0 +1,589 @@
+/*
+  ==============================================================================
+
+    WavetableStore.h
+    Created:    17 Oct 2026 10:40:18am
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include "TableMemory.h"
+#include "ThreadTuning.h"
+
+/// The classic shapes a wave can be recognised as, for the analytic kernels.
+enum class WaveShape
+{
+    other,
+    sine,
+    square,     // sign (sin (angle))
+    triangle    // (2 / pi) * asin (sin (angle))
+};
+
+/// A wave recognised as gain * shape (angle + phase).
+struct WaveShapeFit
+{
+    WaveShape shape = WaveShape::other;
+    float gain = 0.0f, phase = 0.0f;
+};
+
+static_assert (sizeof (WaveShapeFit) == 12, "Written to the wavetable cache as it is");
+
+/// WavetableSet is an immutable block of single-cycle tables: one table per
+/// wave and mip level. Mip 0 keeps every harmonic the table can hold and each
+/// further level halves the harmonic count, so a voice can pick the richest
+/// level that still stays below Nyquist for its pitch.
+///
+/// Every table starts on a 64-byte boundary and carries one guard sample
+/// (a copy of sample 0) so linear interpolation never has to wrap.
+/// Sets are written once by a builder, then sealed and handed to the
+/// WavetableStore; after that they are read-only and safe to share between
+/// voices, engines and threads. A set either owns its TableMemory or views a
+/// slice of a bigger block shared with other sets.
+///
+/// Sealing also analyses the first maxPartials harmonics of every wave, for
+/// rendering it additively (see SineBank) where only a few harmonics fit
+/// below Nyquist. Waves that are a sine, square or triangle to within -40 dB
+/// are recognised too (see getShape()). A set loaded from a cache can be
+/// handed the analysis saved with it instead (see sealWithHash()).
+///
+/// A sparse set has no table memory of its own: its mip levels are attached and
+/// detached one at a time by a decoder (see CompressedWavetableBank), so the
+/// audio thread has to cope with getTable() returning nullptr and should use
+/// findResidentMip() to fall back to a duller level that is present.
+class WavetableSet final : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<WavetableSet>;
+
+    static constexpr int defaultTableSize = 2048;
+    static constexpr int maxMips = 16;
+    static constexpr int maxPartials = 32;
+
+    WavetableSet (int numWavesIn, int tableSizeIn = defaultTableSize,
+                  TableMemory::Backing backing = TableMemory::Backing::standardPages)
+        : WavetableSet (numWavesIn, tableSizeIn,
+                        new TableMemory (getRequiredFloats (numWavesIn, tableSizeIn), backing), 0)
+    {
+    }
+
+    /// Views numWaves tables inside a larger block, e.g. one entry of a WavetableLibrary.
+    /// floatOffset must be a multiple of the table stride to keep the 64-byte alignment.
+    WavetableSet (int numWavesIn, int tableSizeIn, TableMemory::Ptr block, size_t floatOffset)
+        : WavetableSet (numWavesIn, tableSizeIn, SparseTag{})
+    {
+        jassert (floatOffset + getRequiredFloats (numWaves, tableSize) <= block->getNumBytes() / sizeof (float));
+
+        memory = std::move (block);
+        auto* base = memory->getData() + floatOffset;
+
+        for (int mip = 0; mip < numMips; ++mip)
+            mipData[mip].store (base + getMipFloats() * (size_t) mip, std::memory_order_relaxed);
+    }
+
+    /// Creates a sparse set with no mip levels attached yet. `slotPool` is the
+    /// block its levels will be decoded into; the set keeps it alive so that
+    /// attached levels stay valid for as long as any voice holds the set.
+    static Ptr createSparse (int numWaves, int tableSize, TableMemory::Ptr slotPool)
+    {
+        Ptr set = new WavetableSet (numWaves, tableSize, SparseTag{});
+        set->memory = std::move (slotPool);
+        set->sparse = true;
+        return set;
+    }
+
+    static int getNumMipsFor (int tableSize) noexcept       { return jlimit (1, maxMips, (int) std::log2 (tableSize)); }
+    static size_t getStrideFor (int tableSize) noexcept     { return RealtimeArena::alignUp ((size_t) tableSize + 1, RealtimeArena::cacheLineSize / sizeof (float)); }
+
+    static size_t getRequiredFloats (int numWaves, int tableSize) noexcept
+    {
+        return getStrideFor (tableSize) * (size_t) (numWaves * getNumMipsFor (tableSize));
+    }
+
+    TableMemory::Backing getBacking() const noexcept    { return memory->getBacking(); }
+
+    int getNumWaves() const noexcept        { return numWaves; }
+    int getNumMips() const noexcept         { return numMips; }
+    int getTableSize() const noexcept       { return tableSize; }
+    uint64 getContentHash() const noexcept  { return contentHash; }
+    bool isSealed() const noexcept          { return sealed; }
+    bool isSparse() const noexcept          { return sparse; }
+
+    /// Floats taken by one mip level (all waves), which is also the slot size a decoder needs.
+    size_t getMipFloats() const noexcept    { return tableStride * (size_t) numWaves; }
+
+    /// Bytes of table data this set owns or views; zero for sparse sets.
+    size_t getNumBytes() const noexcept     { return isSparse() ? 0 : getMipFloats() * (size_t) numMips * sizeof (float); }
+
+    /// Number of harmonics mip level `mip` was band-limited to.
+    int getNumHarmonics (int mip) const noexcept    { return jmax (1, (tableSize / 2) >> mip); }
+
+    /// The richest mip level whose harmonics all stay below Nyquist for a
+    /// fundamental of cyclesPerSample (frequency / sampleRate).
+    int getMipForIncrement (double cyclesPerSample) const noexcept
+    {
+        auto mip = (int) std::ceil (std::log2 (jmax (cyclesPerSample * tableSize, 1.0)));
+        return jlimit (0, numMips - 1, mip);
+    }
+
+    /// Returns nullptr if the set is sparse and this mip isn't attached.
+    const float* getTable (int wave, int mip) const noexcept
+    {
+        jassert (isPositiveAndBelow (wave, numWaves) && isPositiveAndBelow (mip, numMips));
+        auto* level = mipData[mip].load (std::memory_order_acquire);
+        return level != nullptr ? level + tableStride * (size_t) wave : nullptr;
+    }
+
+    /// The first attached mip at or above `mip` (fewer harmonics never alias),
+    /// or -1 if none is. Missing levels are flagged for the decoder.
+    /// Lock-free, so safe on the audio thread.
+    int findResidentMip (int mip) const noexcept
+    {
+        for (int level = mip; level < numMips; ++level)
+        {
+            if (mipData[level].load (std::memory_order_acquire) != nullptr)
+            {
+                if (sparse)
+                    usedMips.fetch_or (1u << level, std::memory_order_relaxed);
+
+                return level;
+            }
+
+            requestedMips.fetch_or (1u << level, std::memory_order_relaxed);
+        }
+
+        return -1;
+    }
+
+    /// Decoder side of a sparse set: the missing mips voices asked for, and the
+    /// attached ones they played from, since the last call.
+    uint32 takeRequestedMips() noexcept                 { return requestedMips.exchange (0, std::memory_order_relaxed); }
+    uint32 takeUsedMips() noexcept                      { return usedMips.exchange (0, std::memory_order_relaxed); }
+
+    /// Asks the decoder for mips ahead of time (one bit per level).
+    void requestMips (uint32 mask) noexcept             { requestedMips.fetch_or (mask, std::memory_order_relaxed); }
+
+    /// Decoder side of a sparse set: attaches (or with nullptr detaches) one
+    /// fully written mip level. Detached memory may still be read by the audio
+    /// thread until its next block boundary.
+    void setMipData (int mip, float* levelData) noexcept
+    {
+        jassert (isSparse());
+        mipData[mip].store (levelData, std::memory_order_release);
+    }
+
+    bool isMipResident (int mip) const noexcept         { return mipData[mip].load (std::memory_order_acquire) != nullptr; }
+
+    /// Harmonics 1..maxPartials of a wave as complex amplitudes: maxPartials
+    /// real parts, then maxPartials imaginary parts, such that the wave at
+    /// angle theta is the sum of re[h - 1] * cos (h * theta) - im[h - 1] * sin (h * theta).
+    /// nullptr for a sparse set, whose tables weren't there to analyse.
+    const float* getPartials (int wave) const noexcept
+    {
+        jassert (isPositiveAndBelow (wave, numWaves));
+        return partials != nullptr ? partials + (size_t) wave * 2 * maxPartials : nullptr;
+    }
+
+    /// Floats getPartials() covers, over every wave.
+    size_t getNumPartialFloats() const noexcept     { return (size_t) numWaves * 2 * maxPartials; }
+
+    /// What shape a wave is, if it is a classic one. Always WaveShape::other for a sparse set.
+    WaveShapeFit getShape (int wave) const noexcept
+    {
+        jassert (isPositiveAndBelow (wave, numWaves));
+        return shapes != nullptr ? shapes[wave] : WaveShapeFit();
+    }
+
+    /// Only valid while the set is being built, i.e. before seal().
+    float* getWritePointer (int wave, int mip) noexcept
+    {
+        jassert (! sealed && ! isSparse());
+        return const_cast<float*> (getTable (wave, mip));
+    }
+
+    /// Writes the guard samples, hashes the contents and freezes the set.
+    void seal()
+    {
+        jassert (! sealed && ! isSparse());
+
+        for (int wave = 0; wave < numWaves; ++wave)
+            for (int mip = 0; mip < numMips; ++mip)
+            {
+                auto* table = getWritePointer (wave, mip);
+                table[tableSize] = table[0];
+            }
+
+        analysePartials();
+        contentHash = hashBytes (getTable (0, 0), getNumBytes(), hashBytes (&numWaves, sizeof (numWaves), hashBytes (&tableSize, sizeof (tableSize))));
+        sealed = true;
+    }
+
+    /// Seals a set whose contents can't or needn't be hashed here: sparse sets
+    /// (the owner hashes the compressed source data) and sets viewing a cache
+    /// file that was sealed when it was written, guard samples included.
+    /// With savedPartials and savedShapes (laid out as getPartials() and
+    /// getShape() return them, for every wave) the analysis is copied rather
+    /// than redone, so loading from a cache runs no FFTs.
+    void sealWithHash (uint64 hash, const float* savedPartials = nullptr, const WaveShapeFit* savedShapes = nullptr)
+    {
+        jassert (! sealed);
+
+        if (savedPartials != nullptr && savedShapes != nullptr)
+        {
+            partials.malloc ((size_t) numWaves * 2 * maxPartials);
+            shapes.malloc ((size_t) numWaves);
+            std::memcpy (partials, savedPartials, getNumPartialFloats() * sizeof (float));
+            std::memcpy (shapes, savedShapes, (size_t) numWaves * sizeof (WaveShapeFit));
+        }
+        else if (! isSparse())
+        {
+            analysePartials();
+        }
+
+        contentHash = hash;
+        sealed = true;
+    }
+
+    bool hasSameContentAs (const WavetableSet& other) const noexcept
+    {
+        if (contentHash != other.contentHash || numWaves != other.numWaves
+             || tableSize != other.tableSize || isSparse() != other.isSparse())
+            return false;
+
+        return isSparse() || std::memcmp (getTable (0, 0), other.getTable (0, 0), getNumBytes()) == 0;
+    }
+
+    /// 64-bit FNV-1a, chainable through `hash`.
+    static uint64 hashBytes (const void* bytes, size_t numBytes, uint64 hash = 14695981039346656037ull) noexcept
+    {
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ static_cast<const uint8*> (bytes)[i]) * 1099511628211ull;
+
+        return hash;
+    }
+
+private:
+    struct SparseTag {};
+
+    /// Fills `partials` and `shapes` from every wave's mip 0 (the one with every harmonic).
+    void analysePartials()
+    {
+        auto numPartials = jmin (maxPartials, tableSize / 2 - 1);
+        auto scale = 2.0f / (float) tableSize;
+
+        partials.calloc ((size_t) numWaves * 2 * maxPartials);
+        shapes.calloc ((size_t) numWaves);
+        dsp::FFT fft ((int) std::log2 (tableSize));
+        HeapBlock<float> spectrum ((size_t) tableSize * 2);
+
+        for (int wave = 0; wave < numWaves; ++wave)
+        {
+            std::memcpy (spectrum, getTable (wave, 0), sizeof (float) * (size_t) tableSize);
+            FloatVectorOperations::clear (spectrum + tableSize, tableSize);
+            fft.performRealOnlyForwardTransform (spectrum, true);
+
+            auto* re = partials + (size_t) wave * 2 * maxPartials;
+            auto* im = re + maxPartials;
+
+            for (int harmonic = 1; harmonic <= numPartials; ++harmonic)
+            {
+                re[harmonic - 1] = scale * spectrum[2 * harmonic];
+                im[harmonic - 1] = scale * spectrum[2 * harmonic + 1];
+            }
+
+            shapes[wave] = fitShape (spectrum, tableSize);
+        }
+    }
+
+    /// Matches a spectrum against each classic shape, with the gain and phase
+    /// taken from its fundamental. Harmonic h of shape (angle + phase) is the
+    /// shape's own harmonic turned by h * phase.
+    /// Only the lowest 64 harmonics are compared: sampling a square onto the
+    /// table already bends its highest ones by more than the tolerance.
+    static WaveShapeFit fitShape (const float* spectrum, int tableSize) noexcept
+    {
+        auto numHarmonics = jmin (64, tableSize / 2 - 1);
+        const std::complex<double> first (spectrum[2], spectrum[3]);
+        auto firstMagnitude = std::abs (first);
+
+        if (firstMagnitude <= 0.0)
+            return {};
+
+        // The canonical shapes are all sine series, so their fundamental points at -i
+        const auto turn = std::complex<double> (0.0, 1.0) * first / firstMagnitude;
+
+        for (auto shape : { WaveShape::sine, WaveShape::square, WaveShape::triangle })
+        {
+            double error = 0.0, energy = 0.0;
+            auto expected = first;
+
+            for (int harmonic = 1; harmonic <= numHarmonics; ++harmonic)
+            {
+                const std::complex<double> actual (spectrum[2 * harmonic], spectrum[2 * harmonic + 1]);
+                error += std::norm (actual - getHarmonicRatio (shape, harmonic) * expected);
+                energy += std::norm (actual);
+                expected *= turn;
+            }
+
+            if (error < 1.0e-4 * energy)
+            {
+                // The gain is the shape's peak, from its fundamental: 4 / pi for a square, 8 / pi^2 for a triangle
+                constexpr auto pi = MathConstants<double>::pi;
+                auto gainPerFundamental = shape == WaveShape::square ? pi / 4.0 : (shape == WaveShape::triangle ? pi * pi / 8.0 : 1.0);
+                auto fundamental = firstMagnitude * 2.0 / tableSize;
+
+                return { shape, (float) (fundamental * gainPerFundamental), (float) std::arg (turn) };
+            }
+        }
+
+        return {};
+    }
+
+    /// Harmonic h of a shape relative to its fundamental (they all have the same phase or its opposite).
+    static double getHarmonicRatio (WaveShape shape, int harmonic) noexcept
+    {
+        auto odd = (harmonic & 1) != 0;
+
+        switch (shape)
+        {
+            case WaveShape::sine:       return harmonic == 1 ? 1.0 : 0.0;
+            case WaveShape::square:     return odd ? 1.0 / harmonic : 0.0;
+            case WaveShape::triangle:   return odd ? ((harmonic & 2) != 0 ? -1.0 : 1.0) / ((double) harmonic * harmonic) : 0.0;
+            case WaveShape::other:      break;
+        }
+
+        return 0.0;
+    }
+
+    WavetableSet (int numWavesIn, int tableSizeIn, SparseTag)
+        : numWaves (numWavesIn),
+          tableSize (tableSizeIn),
+          numMips (getNumMipsFor (tableSizeIn)),
+          tableStride (getStrideFor (tableSizeIn))
+    {
+        jassert (isPowerOfTwo (tableSize) && numWaves > 0);
+    }
+
+    const int numWaves, tableSize, numMips;
+    const size_t tableStride;
+    TableMemory::Ptr memory;
+    std::atomic<float*> mipData[maxMips] {};
+    HeapBlock<float> partials;
+    HeapBlock<WaveShapeFit> shapes;
+    mutable std::atomic<uint32> requestedMips { 0 }, usedMips { 0 };
+    uint64 contentHash = 0;
+    bool sealed = false, sparse = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavetableSet)
+};
+
+/// WavetableBuilder band-limits single-cycle waveforms into a WavetableSet's
+/// mip levels with juce::dsp::FFT.
+struct WavetableBuilder
+{
+    /// Fills every mip of `wave` from one cycle sampled at set.getTableSize() points.
+    /// The wave is DC-blocked and scaled so mip 0 peaks at 1.
+    static void buildMips (WavetableSet& set, int wave, const float* cycle)
+    {
+        auto tableSize = set.getTableSize();
+        dsp::FFT fft ((int) std::log2 (tableSize));
+        HeapBlock<float> spectrum ((size_t) tableSize * 2, true), work ((size_t) tableSize * 2, true);
+
+        forwardTransform (fft, cycle, spectrum, tableSize);
+
+        auto* mip0 = set.getWritePointer (wave, 0);
+        writeBandLimited (fft, spectrum, work, mip0, tableSize, set.getNumHarmonics (0));
+
+        auto range = FloatVectorOperations::findMinAndMax (mip0, tableSize);
+        auto peak = jmax (std::abs (range.getStart()), std::abs (range.getEnd()));
+        auto scale = peak > 0.0f ? 1.0f / peak : 1.0f;
+        FloatVectorOperations::multiply (mip0, scale, tableSize + 1);
+
+        for (int mip = 1; mip < set.getNumMips(); ++mip)
+            writeBandLimited (fft, spectrum, work, set.getWritePointer (wave, mip), tableSize, set.getNumHarmonics (mip), scale);
+    }
+
+    /// Real-only forward transform of one cycle into `spectrum` (2 * tableSize floats), DC removed.
+    static void forwardTransform (const dsp::FFT& fft, const float* cycle, float* spectrum, int tableSize)
+    {
+        std::memcpy (spectrum, cycle, sizeof (float) * (size_t) tableSize);
+        FloatVectorOperations::clear (spectrum + tableSize, tableSize);
+        fft.performRealOnlyForwardTransform (spectrum, true);
+        spectrum[0] = spectrum[1] = 0.0f;
+    }
+
+    /// Writes one band-limited level (harmonics 1..numHarmonics of `spectrum`)
+    /// into dest, including its guard sample. `work` needs 2 * tableSize floats.
+    static void writeBandLimited (const dsp::FFT& fft, const float* spectrum, float* work, float* dest,
+                                  int tableSize, int numHarmonics, float scale = 1.0f)
+    {
+        std::memcpy (work, spectrum, sizeof (float) * (size_t) tableSize * 2);
+
+        // Zero every bin above the harmonic limit (bins are interleaved re/im)
+        for (int bin = numHarmonics + 1; bin <= tableSize / 2; ++bin)
+            work[2 * bin] = work[2 * bin + 1] = 0.0f;
+
+        fft.performRealOnlyInverseTransform (work);
+        FloatVectorOperations::copyWithMultiply (dest, work, scale, tableSize);
+        dest[tableSize] = dest[0];
+    }
+
+    /// Samples an analytic shape defined over radians [0, 2pi) into one cycle and builds its mips.
+    template <typename ShapeFunction>
+    static void buildMipsFromFunction (WavetableSet& set, int wave, ShapeFunction&& shape)
+    {
+        HeapBlock<float> cycle ((size_t) set.getTableSize());
+
+        for (int i = 0; i < set.getTableSize(); ++i)
+            cycle[i] = (float) shape (MathConstants<double>::twoPi * i / set.getTableSize());
+
+        buildMips (set, wave, cycle);
+    }
+
+    /// Builds a set from numCycles single-cycle waveforms of cycleLength samples
+    /// each, e.g. read from a file. Cycles are resampled linearly to tableSize.
+    /// With a pool, the waves are band-limited in parallel and this returns
+    /// once all of them are done.
+    static WavetableSet::Ptr createFromCycles (const float* const* cycles, int numCycles, int cycleLength,
+                                               int tableSize = WavetableSet::defaultTableSize,
+                                               ThreadPool* pool = nullptr)
+    {
+        jassert (numCycles > 0 && cycleLength > 1);
+
+        WavetableSet::Ptr set = new WavetableSet (numCycles, tableSize);
+
+        auto buildWave = [&set, cycles, cycleLength, tableSize] (int wave)
+        {
+            HeapBlock<float> cycle ((size_t) tableSize);
+            resampleCycle (cycles[wave], cycleLength, cycle, tableSize);
+            buildMips (*set, wave, cycle);
+        };
+
+        if (pool == nullptr || numCycles == 1)
+        {
+            for (int wave = 0; wave < numCycles; ++wave)
+                buildWave (wave);
+
+            return set;
+        }
+
+        // Waves write disjoint tables, so each one is an independent job
+        std::atomic<int> remaining { numCycles };
+        WaitableEvent finished;
+
+        for (int wave = 0; wave < numCycles; ++wave)
+        {
+            pool->addJob ([&buildWave, &remaining, &finished, wave]
+            {
+                ThreadTuning::keepOffRealtimeCores();
+                buildWave (wave);
+
+                if (--remaining == 0)
+                    finished.signal();
+            });
+        }
+
+        finished.wait();
+        return set;
+    }
+
+    /// Linearly resamples one periodic cycle to a new length.
+    static void resampleCycle (const float* source, int sourceLength, float* dest, int destLength) noexcept
+    {
+        for (int i = 0; i < destLength; ++i)
+        {
+            auto position = (double) i * sourceLength / destLength;
+            auto index = (int) position;
+            auto frac = (float) (position - index);
+            auto a = source[index];
+            auto b = source[(index + 1) % sourceLength];
+            dest[i] = a + frac * (b - a);
+        }
+    }
+};
+
+/// WavetableStore is the process-wide home of every WavetableSet.
+/// Hold it through a SharedResourcePointer so all engine instances share one
+/// store. Identical sets are deduplicated by content hash, so memory stays
+/// flat no matter how many voices or instances ask for the same tables; the
+/// voices themselves only keep a WavetableSet::Ptr.
+class WavetableStore
+{
+public:
+    /// Returns the stored set with the same contents as `candidate`, or stores
+    /// and returns `candidate` itself. Seals the candidate if necessary.
+    WavetableSet::Ptr intern (WavetableSet::Ptr candidate)
+    {
+        jassert (candidate != nullptr);
+
+        if (! candidate->isSealed())
+            candidate->seal();
+
+        const ScopedLock sl (lock);
+
+        for (auto* existing : sets)
+            if (existing->hasSameContentAs (*candidate))
+                return existing;
+
+        sets.add (candidate);
+        return candidate;
+    }
+
+    /// The built-in sine, square, triangle and sawtooth morph targets: one per
+    /// corner of the vector morph's defaults.
+    WavetableSet::Ptr getClassicShapes()
+    {
+        const ScopedLock sl (classicLock);
+
+        if (classicShapes == nullptr)
+        {
+            WavetableSet::Ptr set = new WavetableSet (4);
+
+            WavetableBuilder::buildMipsFromFunction (*set, 0, [] (double angle) { return std::sin (angle); });
+            WavetableBuilder::buildMipsFromFunction (*set, 1, [] (double angle) { return 1.0 - 2.0 * static_cast<double> (std::sin (angle) < 0.0); });
+            WavetableBuilder::buildMipsFromFunction (*set, 2, [] (double angle) { return (2.0 / MathConstants<double>::pi) * std::asin (std::sin (angle)); });
+            WavetableBuilder::buildMipsFromFunction (*set, 3, [] (double angle) { return 1.0 - angle / MathConstants<double>::pi; });
+
+            classicShapes = intern (set);
+        }
+
+        return classicShapes;
+    }
+
+    /// Drops every set nobody but the store references any more.
+    /// Call from the message thread or a background thread, never the audio thread.
+    void purgeUnused()
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = sets.size(); --i >= 0;)
+            if (sets.getUnchecked (i)->getReferenceCount() == 1)
+                sets.remove (i);
+    }
+
+    int getNumSets() const
+    {
+        const ScopedLock sl (lock);
+        return sets.size();
+    }
+
+    size_t getTotalBytes() const
+    {
+        const ScopedLock sl (lock);
+        size_t total = 0;
+
+        for (auto* set : sets)
+            total += set->getNumBytes();
+
+        return total;
+    }
+
+private:
+    CriticalSection lock, classicLock;
+    ReferenceCountedArray<WavetableSet> sets;
+    WavetableSet::Ptr classicShapes;
+};